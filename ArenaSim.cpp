@@ -0,0 +1,276 @@
+#include "ArenaSim.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <limits>
+
+// squared distance from point 'pt' to the segment from 'a' to 'b' (as in SnakeSim):
+static float inline segment_distance2(glm::vec2 const &pt, glm::vec2 const &a, glm::vec2 const &b) {
+	glm::vec2 ab = b - a;
+	glm::vec2 ap = pt - a;
+	float len2 = ab.x * ab.x + ab.y * ab.y;
+	float inv_len2 = (len2 > 0.0f ? 1.0f / len2 : 0.0f);
+	float t = (ap.x * ab.x + ap.y * ab.y) * inv_len2;
+	t = std::min(std::max(t, 0.0f), 1.0f);
+	float ex = ap.x - t * ab.x;
+	float ey = ap.y - t * ab.y;
+	return ex * ex + ey * ey;
+}
+
+ArenaSim::ArenaSim(size_t snakes, uint32_t seed, SnakeConfig const &config) : sim(snakes, seed, config) {
+	snake_collided.resize(snakes, 0);
+	snake_hits.resize(snakes, 0);
+	proxy_lo.resize(snakes, 1);
+	proxy_hi.resize(snakes, 0);
+	spread();
+}
+
+void ArenaSim::spread() {
+	glm::vec2 const wall = sim.config.court_size - SnakeSim::snake_size;
+	for (size_t s = 0; s < size(); ++s) {
+		sim.setup(s);
+		float y = -wall.y + (s + 0.5f) * (2.0f * wall.y / size());
+		float direction = (s % 2 == 0 ? -1.0f : 1.0f);
+		//centered in the court, heading for one of the paddles:
+		sim.place(s, glm::vec2(0.5f * direction * sim.snake_length[s], y), glm::vec2(direction, 0.0f));
+		sim.green_fruit[s] = sim.spawn_fruit(s);
+		snake_collided[s] = 0;
+		snake_hits[s] = 0;
+	}
+}
+
+size_t ArenaSim::alive() const {
+	size_t count = 0;
+	for (size_t s = 0; s < size(); ++s) {
+		count += (sim.running[s] != 0);
+	}
+	return count;
+}
+
+void ArenaSim::update(float elapsed) {
+	//everyone plays against the same paddles (snake zero's):
+	for (size_t s = 1; s < size(); ++s) {
+		sim.left_input[s] = sim.left_input[0];
+		sim.left_paddle[s] = sim.left_paddle[0];
+		sim.right_paddle[s] = sim.right_paddle[0];
+	}
+
+	sim.update(elapsed);
+
+	update_proxies();
+	find_candidates();
+	test_candidates();
+
+	//damage heads that ran into other snakes (once per contact):
+	std::vector< uint8_t > touching(size(), 0);
+	for (size_t c = 0; c < candidates.size(); ++c) {
+		if (candidate_hits[c]) touching[candidates[c].first] = 1;
+	}
+	for (size_t s = 0; s < size(); ++s) {
+		if (!sim.running[s]) continue;
+		if (touching[s] && !snake_collided[s]) {
+			sim.damaged(s, sim.config.collision_damage);
+			snake_hits[s] += 1;
+		}
+		snake_collided[s] = touching[s];
+	}
+}
+
+void ArenaSim::update_proxies() {
+	//which segments should have proxies now? (serials [lo, hi], or none for snakes that are done):
+	size_t const count = size();
+	std::vector< uint32_t > lo(count), hi(count);
+	for (size_t s = 0; s < count; ++s) {
+		size_t n = sim.snake_vertices[s].size();
+		if (!sim.running[s] || n < 2) {
+			lo[s] = 1;
+			hi[s] = 0;
+			continue;
+		}
+		hi[s] = sim.head_serial[s];
+		lo[s] = sim.head_serial[s] - uint32_t(n - 2);
+		//a restarted snake's serials start over, so none of its old proxies are any good:
+		if (hi[s] < proxy_hi[s]) {
+			proxy_lo[s] = 1;
+			proxy_hi[s] = 0;
+		}
+	}
+
+	auto refresh = [this](Proxy &p) {
+		RingBuffer< glm::vec2 > const &vertices = sim.snake_vertices[p.snake];
+		uint32_t i = sim.head_serial[p.snake] - p.serial;
+		glm::vec2 const &a = vertices[i];
+		glm::vec2 const &b = vertices[i+1];
+		p.min_x = std::min(a.x, b.x);
+		p.max_x = std::max(a.x, b.x);
+		p.min_y = std::min(a.y, b.y);
+		p.max_y = std::max(a.y, b.y);
+	};
+
+	//drop proxies for segments that are gone and refresh those that may have moved
+	// (the head and tail segments, and -- since push_head can merge vertices -- anything made this update):
+	size_t keep = 0;
+	for (size_t i = 0; i < proxies.size(); ++i) {
+		Proxy p = proxies[i];
+		uint32_t s = p.snake;
+		if (p.serial < proxy_lo[s] || p.serial > proxy_hi[s] || p.serial < lo[s] || p.serial > hi[s]) continue;
+		if (p.serial + 1 >= proxy_hi[s] || p.serial == lo[s]) refresh(p);
+		proxies[keep++] = p;
+	}
+	proxies.resize(keep);
+
+	//insertion sort -- nearly everything is still in order from last time:
+	auto by_min_x = [](Proxy const &a, Proxy const &b){ return a.min_x < b.min_x; };
+	for (size_t i = 1; i < proxies.size(); ++i) {
+		if (!by_min_x(proxies[i], proxies[i-1])) continue;
+		Proxy p = proxies[i];
+		size_t j = i;
+		while (j > 0 && by_min_x(p, proxies[j-1])) {
+			proxies[j] = proxies[j-1];
+			j -= 1;
+		}
+		proxies[j] = p;
+	}
+
+	//add proxies for segments that are new (at the head end, or everything for a restarted snake):
+	auto add = [&](uint32_t s, uint32_t begin, uint32_t end) {
+		for (uint32_t serial = begin; serial < end; ++serial) {
+			Proxy p;
+			p.snake = s;
+			p.serial = serial;
+			refresh(p);
+			proxies.emplace_back(p);
+		}
+	};
+	for (uint32_t s = 0; s < count; ++s) {
+		if (lo[s] <= hi[s]) {
+			uint32_t kept_lo = std::max(proxy_lo[s], lo[s]);
+			uint32_t kept_hi = std::min(proxy_hi[s], hi[s]);
+			if (kept_lo > kept_hi) {
+				add(s, lo[s], hi[s] + 1);
+			} else {
+				add(s, lo[s], kept_lo);
+				add(s, kept_hi + 1, hi[s] + 1);
+			}
+		}
+		proxy_lo[s] = lo[s];
+		proxy_hi[s] = hi[s];
+	}
+
+	//new proxies (which can be anywhere, and are all of them on the first update) are sorted on their own and merged in:
+	std::sort(proxies.begin() + keep, proxies.end(), by_min_x);
+	std::inplace_merge(proxies.begin(), proxies.begin() + keep, proxies.end(), by_min_x);
+}
+
+void ArenaSim::find_candidates() {
+	float const diameter = 2.0f * SnakeSim::snake_radius;
+	heads.clear();
+	for (size_t s = 0; s < size(); ++s) {
+		if (!sim.running[s]) continue;
+		glm::vec2 head = sim.snake_vertices[s][0];
+		HeadBox box;
+		box.min_x = head.x - diameter;
+		box.max_x = head.x + diameter;
+		box.min_y = head.y - diameter;
+		box.max_y = head.y + diameter;
+		box.snake = uint32_t(s);
+		heads.emplace_back(box);
+	}
+	std::sort(heads.begin(), heads.end(), [](HeadBox const &a, HeadBox const &b){ return a.min_x < b.min_x; });
+
+	//sweep along x; 'active' holds proxies that started earlier and may still overlap, 'active_heads' the same for heads:
+	candidates.clear();
+	active.clear();
+	std::vector< uint32_t > active_heads;
+	auto start_head = [&](uint32_t h) {
+		HeadBox const &box = heads[h];
+		size_t keep = 0;
+		for (uint32_t a : active) {
+			Proxy const &p = proxies[a];
+			if (p.max_x < box.min_x) continue; //(ended before this head, so before all later heads too)
+			active[keep++] = a;
+			if ((p.snake != box.snake) & (p.min_y <= box.max_y) & (p.max_y >= box.min_y)) {
+				candidates.emplace_back(box.snake, a);
+			}
+		}
+		active.resize(keep);
+		active_heads.emplace_back(h);
+	};
+
+	//proxies are handled in runs over which the set of active heads doesn't change, so the inner loops are short and predictable:
+	float const never = std::numeric_limits< float >::infinity();
+	uint32_t next_head = 0;
+	for (uint32_t i = 0; i < proxies.size(); ) {
+		float min_x = proxies[i].min_x;
+		while (next_head < heads.size() && heads[next_head].min_x <= min_x) {
+			start_head(next_head++);
+		}
+		float next_start = (next_head < heads.size() ? heads[next_head].min_x : never);
+		float first_end = never;
+		size_t keep = 0;
+		for (uint32_t h : active_heads) {
+			if (heads[h].max_x < min_x) continue;
+			active_heads[keep++] = h;
+			first_end = std::min(first_end, heads[h].max_x);
+		}
+		active_heads.resize(keep);
+
+		uint32_t end = i + 1;
+		while (end < proxies.size() && proxies[end].min_x < next_start && proxies[end].min_x <= first_end) ++end;
+
+		for (uint32_t h : active_heads) {
+			HeadBox const &box = heads[h];
+			for (uint32_t j = i; j < end; ++j) {
+				Proxy const &p = proxies[j];
+				if ((p.snake != box.snake) & (p.min_y <= box.max_y) & (p.max_y >= box.min_y)) {
+					candidates.emplace_back(box.snake, j);
+				}
+			}
+		}
+		//(a proxy that ends before the next head starts can't overlap that head or any after it)
+		for (uint32_t j = i; j < end; ++j) {
+			if (proxies[j].max_x >= next_start) active.emplace_back(j);
+		}
+		i = end;
+	}
+	while (next_head < heads.size()) {
+		start_head(next_head++);
+	}
+}
+
+void ArenaSim::test_candidates() {
+	float const diameter = 2.0f * SnakeSim::snake_radius;
+	candidate_hits.assign(candidates.size(), 0);
+	auto test = [this, diameter](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; ++c) {
+			glm::vec2 head = sim.snake_vertices[candidates[c].first][0];
+			Proxy const &p = proxies[candidates[c].second];
+			RingBuffer< glm::vec2 > const &vertices = sim.snake_vertices[p.snake];
+			uint32_t i = sim.head_serial[p.snake] - p.serial;
+			candidate_hits[c] = (segment_distance2(head, vertices[i], vertices[i+1]) < diameter * diameter);
+		}
+	};
+
+	//(small batches aren't worth waking the pool for)
+	size_t const chunk = 2048;
+	if (pool && candidates.size() > 2 * chunk) {
+		pool->parallel_for((candidates.size() + chunk - 1) / chunk, [&](size_t index, size_t) {
+			test(index * chunk, std::min(candidates.size(), (index + 1) * chunk));
+		});
+	} else {
+		test(0, candidates.size());
+	}
+}
+
+bool ArenaSim::head_hits_other_scan(size_t s) const {
+	float const diameter = 2.0f * SnakeSim::snake_radius;
+	glm::vec2 head = sim.snake_vertices[s][0];
+	for (size_t o = 0; o < size(); ++o) {
+		if (o == s || !sim.running[o]) continue;
+		RingBuffer< glm::vec2 > const &vertices = sim.snake_vertices[o];
+		for (size_t i = 0; i + 1 < vertices.size(); ++i) {
+			if (segment_distance2(head, vertices[i], vertices[i+1]) < diameter * diameter) return true;
+		}
+	}
+	return false;
+}
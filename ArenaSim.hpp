@@ -0,0 +1,79 @@
+#pragma once
+
+#include "SnakeSim.hpp"
+
+#include <vector>
+#include <cstdint>
+
+struct ThreadPool;
+
+/*
+ * ArenaSim puts many snakes in one court: each snake is a game of an inner
+ * SnakeSim (so it has its own vertices, velocity, health, and fruit, and still
+ * runs into its own body), all games share the court and snake zero's paddles,
+ * and a snake whose head runs into another snake's body takes collision damage.
+ *
+ * Snake-vs-snake contacts are found with a sort-and-sweep broadphase over the
+ * bounding boxes of every body segment. The boxes stay sorted along x from one
+ * update to the next -- most segments never move, so an insertion sort puts the
+ * few that changed back in order, and new segments are sorted on their own and
+ * merged in -- and the sweep pairs each head's box with the segment boxes it
+ * overlaps. The exact head-vs-segment tests (the narrowphase) can then run on
+ * a ThreadPool.
+ */
+
+struct ArenaSim {
+	//'snakes' snakes, spread out over the court (see spread):
+	ArenaSim(size_t snakes, uint32_t seed = 0, SnakeConfig const &config = SnakeConfig());
+
+	//the snakes; input goes to snake zero (its left_input and right_paddle move everyone's paddles):
+	SnakeSim sim;
+	size_t size() const { return sim.size(); }
+
+	//if set, the narrowphase runs on this pool (when there are enough candidate pairs to be worth it):
+	ThreadPool *pool = nullptr;
+
+	//restarts every snake, laid out in rows across the court, alternating directions:
+	void spread();
+	//advances every snake by 'elapsed' seconds, then applies snake-vs-snake collisions:
+	void update(float elapsed);
+
+	//number of snakes still running:
+	size_t alive() const;
+
+	//----- snake-vs-snake collision state, one per snake -----
+	std::vector< uint8_t > snake_collided; //(like SnakeSim::last_collided, so one contact only does damage once)
+	std::vector< uint32_t > snake_hits; //times this snake's head ran into another snake
+
+	//----- broadphase -----
+	//a segment's bounding box; segment 'serial' of 'snake' runs from its vertex (head_serial - serial) toward the tail:
+	struct Proxy {
+		float min_x, max_x, min_y, max_y;
+		uint32_t snake;
+		uint32_t serial;
+	};
+	std::vector< Proxy > proxies; //sorted by min_x (as of the last update)
+	//each snake's proxies have serials [proxy_lo, proxy_hi] (empty if proxy_lo > proxy_hi):
+	std::vector< uint32_t > proxy_lo, proxy_hi;
+
+	struct HeadBox {
+		float min_x, max_x, min_y, max_y;
+		uint32_t snake;
+	};
+	std::vector< HeadBox > heads; //sorted by min_x
+
+	//(head snake, proxy index) pairs whose boxes overlap, and the narrowphase result for each:
+	std::vector< std::pair< uint32_t, uint32_t > > candidates;
+	std::vector< uint8_t > candidate_hits;
+	std::vector< uint32_t > active; //scratch for the sweep (proxy indices)
+
+	//brings proxies up to date with the snakes and re-sorts them:
+	void update_proxies();
+	//sweeps heads against proxies, filling 'candidates':
+	void find_candidates();
+	//exact tests of 'candidates', filling 'candidate_hits':
+	void test_candidates();
+
+	//is snake s's head touching another snake? (checks every segment of every snake -- the reference for the above)
+	bool head_hits_other_scan(size_t s) const;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * CounterRng is a counter-based random number generator ("Squares", Widynski 2020):
+ * the n'th output is a pure function of (key, n), so a stream is just a key and
+ * a counter -- eight bytes of state, cheap to copy, and trivially skipped ahead.
+ *
+ * Streams are identified by (seed, stream); each pair gets its own key, so every
+ * game (and every bot, thread, or anything else that needs randomness) can draw
+ * from an independent stream without sharing or coordinating generators.
+ *
+ * Satisfies UniformRandomBitGenerator, so it also works with <random> distributions.
+ */
+
+struct CounterRng {
+	typedef uint32_t result_type;
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return 0xffffffffu; }
+
+	explicit CounterRng(uint32_t seed = 0, uint32_t stream = 0) : key(make_key(seed, stream)) { }
+
+	uint64_t key;
+	uint64_t counter = 0;
+
+	result_type operator()() { return squares(counter++, key); }
+	//uniform in [0, 1):
+	float uniform() { return ((*this)() >> 8) * (1.0f / 16777216.0f); }
+	//skips the next 'count' outputs:
+	void discard(uint64_t count) { counter += count; }
+
+	//four rounds of squaring (the output is the upper half of the last square):
+	static uint32_t squares(uint64_t ctr, uint64_t key) {
+		uint64_t x = ctr * key;
+		uint64_t y = x;
+		uint64_t z = y + key;
+		x = x * x + y; x = (x >> 32) | (x << 32);
+		x = x * x + z; x = (x >> 32) | (x << 32);
+		x = x * x + y; x = (x >> 32) | (x << 32);
+		return uint32_t((x * x + z) >> 32);
+	}
+
+	//keys should look random (well-mixed bits in both halves) and be odd; splitmix64 of the stream id does that:
+	static uint64_t make_key(uint32_t seed, uint32_t stream) {
+		uint64_t z = ((uint64_t(stream) << 32) | seed) + 0x9e3779b97f4a7c15ULL;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		z = z ^ (z >> 31);
+		return z | 1;
+	}
+};
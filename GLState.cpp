@@ -0,0 +1,94 @@
+#include "GLState.hpp"
+
+GLState gl_state;
+
+void GLState::set_cap(GLenum cap, bool enabled) {
+	for (Cap &known : caps) {
+		if (known.cap != cap) continue;
+		if (known.enabled == enabled) {
+			counts.elided += 1;
+			return;
+		}
+		known.enabled = enabled;
+		if (enabled) glEnable(cap);
+		else glDisable(cap);
+		counts.issued += 1;
+		return;
+	}
+	caps.emplace_back(Cap{cap, enabled});
+	if (enabled) glEnable(cap);
+	else glDisable(cap);
+	counts.issued += 1;
+}
+
+void GLState::enable(GLenum cap) {
+	set_cap(cap, true);
+}
+
+void GLState::disable(GLenum cap) {
+	set_cap(cap, false);
+}
+
+void GLState::blend_func(GLenum sfactor, GLenum dfactor) {
+	if (sfactor == blend_sfactor && dfactor == blend_dfactor) {
+		counts.elided += 1;
+		return;
+	}
+	blend_sfactor = sfactor;
+	blend_dfactor = dfactor;
+	glBlendFunc(sfactor, dfactor);
+	counts.issued += 1;
+}
+
+void GLState::use_program(GLuint program_) {
+	if (program_ == program) {
+		counts.elided += 1;
+		return;
+	}
+	program = program_;
+	glUseProgram(program);
+	counts.issued += 1;
+}
+
+void GLState::bind_vertex_array(GLuint vertex_array_) {
+	if (vertex_array_ == vertex_array) {
+		counts.elided += 1;
+		return;
+	}
+	vertex_array = vertex_array_;
+	glBindVertexArray(vertex_array);
+	counts.issued += 1;
+}
+
+void GLState::bind_texture(GLuint unit, GLenum target, GLuint texture) {
+	Binding *binding = nullptr;
+	for (Binding &known : bindings) {
+		if (known.unit == unit && known.target == target) binding = &known;
+	}
+	if (binding && binding->texture == texture) {
+		counts.elided += 1;
+		return;
+	}
+	if (!binding) {
+		bindings.emplace_back(Binding{unit, target, ~0u});
+		binding = &bindings.back();
+	}
+	//(glBindTexture binds to the active unit, so make it 'unit' first)
+	if (active_unit != unit) {
+		active_unit = unit;
+		glActiveTexture(GL_TEXTURE0 + unit);
+		counts.issued += 1;
+	}
+	binding->texture = texture;
+	glBindTexture(target, texture);
+	counts.issued += 1;
+}
+
+void GLState::invalidate() {
+	caps.clear();
+	blend_sfactor = blend_dfactor = ~0u;
+	program = ~0u;
+	vertex_array = ~0u;
+	active_unit = ~0u;
+	bindings.clear();
+}
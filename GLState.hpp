@@ -0,0 +1,66 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * GLState remembers the OpenGL state set through it -- enabled capabilities,
+ * blend function, current program, vertex array object, and each texture
+ * unit's bindings (per target, so a unit's GL_TEXTURE_2D and GL_TEXTURE_BUFFER
+ * bindings are separate) -- and skips calls that wouldn't change anything.
+ *
+ * Because of that, drawing code can set everything it needs every frame, and
+ * needn't unbind it afterward: only the calls that change state reach the driver.
+ *
+ * State it hasn't seen set is unknown, and the first call to set it always goes
+ * through. Code that changes this state directly (or deletes a bound object,
+ * whose name may then be reused) must call invalidate() afterward.
+ *
+ * OpenGL state belongs to the context, and there's one of those, so there's one of these: gl_state.
+ */
+
+struct GLState {
+	//glEnable / glDisable:
+	void enable(GLenum cap);
+	void disable(GLenum cap);
+	//glBlendFunc:
+	void blend_func(GLenum sfactor, GLenum dfactor);
+	//glUseProgram:
+	void use_program(GLuint program);
+	//glBindVertexArray:
+	void bind_vertex_array(GLuint vertex_array);
+	//glBindTexture on texture unit 'unit' (i.e., GL_TEXTURE0 + unit -- glActiveTexture is called as needed):
+	void bind_texture(GLuint unit, GLenum target, GLuint texture);
+
+	//forget everything (so the next call to set anything goes through):
+	void invalidate();
+
+	//calls made since 'counts' was last reset (e.g., at the start of a frame):
+	struct Counts {
+		uint32_t issued = 0; //(passed to OpenGL, including the glActiveTexture calls bind_texture needs)
+		uint32_t elided = 0; //(skipped because they wouldn't have changed anything)
+	} counts;
+
+	//----- internals -----
+	//(a name of ~0u means "unknown")
+	struct Cap {
+		GLenum cap;
+		bool enabled;
+	};
+	std::vector< Cap > caps; //(capabilities not listed are unknown)
+	GLenum blend_sfactor = ~0u, blend_dfactor = ~0u;
+	GLuint program = ~0u;
+	GLuint vertex_array = ~0u;
+	GLuint active_unit = ~0u;
+	struct Binding {
+		GLuint unit;
+		GLenum target;
+		GLuint texture;
+	};
+	std::vector< Binding > bindings; //(unit/target pairs not listed are unknown)
+	void set_cap(GLenum cap, bool enabled);
+};
+
+extern GLState gl_state;
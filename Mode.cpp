@@ -2,6 +2,8 @@
 
 std::shared_ptr< Mode > Mode::current;
 
+float Mode::tick = 1.0f / 60.0f;
+
 void Mode::set_current(std::shared_ptr< Mode > const &new_current) {
 	current = new_current;
 	//NOTE: may wish to, e.g., trigger resize events on new current mode.
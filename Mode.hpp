@@ -13,12 +13,18 @@ struct Mode : std::enable_shared_from_this< Mode > {
 	//The function should return 'true' if it handled the event.
 	virtual bool handle_event(SDL_Event const &, glm::uvec2 const &window_size) { return false; }
 
-	//update is called at the start of a new frame, after events are handled:
-	// 'elapsed' is time in seconds since the last call to 'update'
+	//update is called after events are handled, zero or more times per frame:
+	// 'elapsed' is always Mode::tick seconds -- the main loop calls update as often as needed to keep up with real time
 	virtual void update(float elapsed) { }
 
 	//draw is called after update:
+	// ('interpolation' says how far real time has gotten between the previous update and the latest one, in [0,1];
+	//  draw may blend the two states by this much, so motion stays smooth at any refresh rate)
 	virtual void draw(glm::uvec2 const &drawable_size) = 0;
+	float interpolation = 1.0f;
+
+	//length of one update, in seconds (1 / updates per second):
+	static float tick;
 
 	//Mode::current is the Mode to which events are dispatched.
 	// use 'set_current' to change the current Mode (e.g., to switch to a menu)
@@ -0,0 +1,338 @@
+#include "Netplay.hpp"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+constexpr uint32_t Netplay::min_delay;
+constexpr uint32_t Netplay::max_delay;
+constexpr uint32_t Netplay::window;
+constexpr uint32_t Netplay::max_batch;
+constexpr uint32_t Netplay::sent_checksums;
+
+#ifdef _WIN32
+static uintptr_t const no_socket = uintptr_t(INVALID_SOCKET);
+static void close_socket(uintptr_t s) { closesocket(SOCKET(s)); }
+#else
+static uintptr_t const no_socket = uintptr_t(-1);
+static void close_socket(uintptr_t s) { close(int(s)); }
+#endif
+
+Netplay::Netplay(Side side_, uint16_t local_port, std::string const &remote_host, uint16_t remote_port, uint32_t session_, float tick_)
+	: side(side_), session(session_), tick(tick_), delay(3), socket(no_socket), rng(session_, 2 + side_) {
+	//(bots use CounterRng stream 1 -- see PaddleBot -- so the simulated network uses streams 2 and 3)
+	start = uint64_t(std::chrono::duration_cast< std::chrono::milliseconds >(std::chrono::steady_clock::now().time_since_epoch()).count());
+
+#ifdef _WIN32
+	WSADATA wsa_data;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+		throw std::runtime_error("Failed to start Winsock.");
+	}
+#endif
+
+	addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	addrinfo *found = nullptr;
+	if (getaddrinfo(remote_host.c_str(), std::to_string(remote_port).c_str(), &hints, &found) != 0 || !found) {
+		throw std::runtime_error("Failed to look up netplay peer '" + remote_host + "'.");
+	}
+	remote_address_size = uint32_t(std::min(size_t(found->ai_addrlen), remote_address.size()));
+	std::memcpy(remote_address.data(), found->ai_addr, remote_address_size);
+	freeaddrinfo(found);
+
+	socket = uintptr_t(::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+	if (socket == no_socket) {
+		throw std::runtime_error("Failed to make a UDP socket for netplay.");
+	}
+	sockaddr_in local;
+	std::memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port = htons(local_port);
+	if (bind(socket, reinterpret_cast< sockaddr * >(&local), sizeof(local)) != 0) {
+		close_socket(socket);
+		throw std::runtime_error("Failed to bind UDP port " + std::to_string(local_port) + " for netplay.");
+	}
+	//(poll never waits on the network)
+#ifdef _WIN32
+	u_long non_blocking = 1;
+	ioctlsocket(SOCKET(socket), FIONBIO, &non_blocking);
+#else
+	fcntl(int(socket), F_SETFL, fcntl(int(socket), F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+Netplay::~Netplay() {
+	close_socket(socket);
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+uint32_t Netplay::now() const {
+	uint64_t ms = uint64_t(std::chrono::duration_cast< std::chrono::milliseconds >(std::chrono::steady_clock::now().time_since_epoch()).count());
+	return uint32_t(ms - start);
+}
+
+float Netplay::silence() const {
+	return (now() - last_heard) / 1000.0f;
+}
+
+void Netplay::poll() {
+	uint32_t time = now();
+
+	//send packets that have been held long enough:
+	for (auto h = held.begin(); h != held.end(); ) {
+		if (int32_t(time - h->release) >= 0) {
+			sendto(socket, reinterpret_cast< char const * >(h->data.data()), int(h->data.size()), 0,
+				reinterpret_cast< sockaddr const * >(remote_address.data()), remote_address_size);
+			h = held.erase(h);
+		} else {
+			++h;
+		}
+	}
+
+	uint8_t buffer[2048];
+	while (true) {
+		auto got = recvfrom(socket, reinterpret_cast< char * >(buffer), sizeof(buffer), 0, nullptr, nullptr);
+		if (got < 0) break; //(nothing more waiting -- or an error, which is about the same thing for UDP)
+		receive(buffer, size_t(got));
+	}
+
+	//keep acknowledgements and checksums flowing even when there's no new input (e.g., while waiting on the other peer):
+	if (time - last_send >= uint32_t(std::ceil(tick * 1000.0f))) send();
+}
+
+bool Netplay::schedule(Input const &input) {
+	//input for update u is sent when the local game is on update u - delay, and it should get to the other
+	// peer before the other peer is on update u, so the delay should cover a one-way trip (plus some slack):
+	if (rtt > 0.0f) {
+		float one_way = 0.5f * rtt + 2.0f * rtt_deviation;
+		uint32_t target = uint32_t(std::ceil(one_way / tick)) + 1;
+		target = std::min(std::max(target, min_delay), max_delay);
+		//(grow right away, since a short delay stalls the game; shrink slowly, since that's only a little less responsive)
+		if (target > delay) delay = target;
+		else if (target + 1 < delay) delay -= 1;
+	}
+
+	//(a shorter delay than before just means no new input until the game catches up to what is scheduled)
+	bool used = false;
+	while (local_end <= update + delay && local_end - acked < window) {
+		local_inputs[local_end % window] = input;
+		local_end += 1;
+		used = true;
+	}
+	if (used) send();
+	return used;
+}
+
+bool Netplay::ready() const {
+	return update < local_end && update < remote_end;
+}
+
+Netplay::Input Netplay::input(Side player) const {
+	return (player == side ? local_inputs : remote_inputs)[update % window];
+}
+
+void Netplay::advance(uint64_t checksum) {
+	Checksum &c = local_checksums[update % window];
+	c.update = update;
+	c.value = checksum;
+	c.compared = false;
+	compare(update);
+	update += 1;
+}
+
+void Netplay::compare(uint32_t u) {
+	Checksum &local = local_checksums[u % window];
+	Checksum const &remote = remote_checksums[u % window];
+	if (local.update != u || remote.update != u || local.compared) return;
+	local.compared = true;
+	checked += 1;
+	if (local.value != remote.value) {
+		if (desyncs == 0) first_desync = u;
+		desyncs += 1;
+	}
+}
+
+//----- packet format -----
+//(everything little-endian)
+// "snkn" magic, uint32 session, uint8 side,
+// uint32 remote_end (acknowledges inputs before it), uint32 checked,
+// uint32 send time, uint32 echoed send time, uint32 time since the echoed packet arrived (0xffffffff if no echo),
+// uint32 first input update, uint8 input count, then per input: float value, uint8 restart
+// uint8 checksum count, then per checksum: uint32 update, uint64 value
+
+static char const magic[4] = {'s', 'n', 'k', 'n'};
+
+static void put(std::vector< uint8_t > &to, uint64_t bits, uint32_t bytes) {
+	for (uint32_t i = 0; i < bytes; ++i) {
+		to.emplace_back(uint8_t((bits >> (8 * i)) & 0xff));
+	}
+}
+
+static void put_float(std::vector< uint8_t > &to, float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, 4);
+	put(to, bits, 4);
+}
+
+//reads from a packet; sets 'ok' to false (and returns zero) past the end:
+struct PacketReader {
+	uint8_t const *data;
+	size_t size;
+	size_t at = 0;
+	bool ok = true;
+	uint64_t get(uint32_t bytes) {
+		if (at + bytes > size) {
+			ok = false;
+			return 0;
+		}
+		uint64_t bits = 0;
+		for (uint32_t i = 0; i < bytes; ++i) {
+			bits |= uint64_t(data[at + i]) << (8 * i);
+		}
+		at += bytes;
+		return bits;
+	}
+	float get_float() {
+		uint32_t bits = uint32_t(get(4));
+		float value;
+		std::memcpy(&value, &bits, 4);
+		return value;
+	}
+};
+
+void Netplay::send() {
+	uint32_t time = now();
+	last_send = time;
+
+	std::vector< uint8_t > packet;
+	packet.reserve(40 + 5 * max_batch + 12 * sent_checksums);
+	packet.insert(packet.end(), magic, magic + 4);
+	put(packet, session, 4);
+	put(packet, side, 1);
+	put(packet, remote_end, 4);
+	put(packet, checked, 4);
+	put(packet, time, 4);
+	put(packet, echo, 4);
+	put(packet, has_echo ? time - echo_received : 0xffffffffu, 4);
+
+	//every input the other peer doesn't have yet (oldest first, if there are too many for one packet):
+	uint32_t count = std::min(local_end - acked, max_batch);
+	put(packet, acked, 4);
+	put(packet, count, 1);
+	for (uint32_t u = acked; u < acked + count; ++u) {
+		Input const &in = local_inputs[u % window];
+		put_float(packet, in.value);
+		put(packet, in.restart, 1);
+	}
+
+	uint32_t checksums = std::min(update, sent_checksums);
+	put(packet, checksums, 1);
+	for (uint32_t u = update - checksums; u < update; ++u) {
+		put(packet, u, 4);
+		put(packet, local_checksums[u % window].value, 8);
+	}
+
+	transmit(packet);
+}
+
+void Netplay::transmit(std::vector< uint8_t > const &data) {
+	packets_sent += 1;
+	if (loss > 0.0f && rng.uniform() < loss) {
+		packets_dropped += 1;
+		return;
+	}
+	if (latency > 0.0f || jitter > 0.0f) {
+		float hold = latency + jitter * rng.uniform();
+		held.emplace_back(Held{now() + uint32_t(hold * 1000.0f), data});
+		return;
+	}
+	sendto(socket, reinterpret_cast< char const * >(data.data()), int(data.size()), 0,
+		reinterpret_cast< sockaddr const * >(remote_address.data()), remote_address_size);
+}
+
+void Netplay::receive(uint8_t const *data, size_t size) {
+	uint32_t time = now();
+	if (size < 4 || std::memcmp(data, magic, 4) != 0) return;
+	PacketReader from{data, size};
+	from.at = 4;
+	uint32_t packet_session = uint32_t(from.get(4));
+	uint8_t packet_side = uint8_t(from.get(1));
+	if (!from.ok || packet_session != session || packet_side == side) return; //(not from this game's other peer)
+
+	uint32_t their_remote_end = uint32_t(from.get(4));
+	uint32_t their_checked = uint32_t(from.get(4));
+	uint32_t sent = uint32_t(from.get(4));
+	uint32_t echoed = uint32_t(from.get(4));
+	uint32_t echo_age = uint32_t(from.get(4));
+	uint32_t first = uint32_t(from.get(4));
+	uint32_t count = uint32_t(from.get(1));
+	if (!from.ok) return;
+
+	packets_received += 1;
+	last_heard = time;
+
+	//round trip time (less however long the other peer sat on the echoed time), smoothed as in TCP (RFC 6298):
+	if (echo_age != 0xffffffffu && time - echoed >= echo_age) {
+		float sample = (time - echoed - echo_age) / 1000.0f;
+		if (rtt == 0.0f) {
+			rtt = sample;
+			rtt_deviation = 0.5f * sample;
+		} else {
+			rtt_deviation = 0.75f * rtt_deviation + 0.25f * std::abs(rtt - sample);
+			rtt = 0.875f * rtt + 0.125f * sample;
+		}
+	}
+	//(packets can arrive out of order; echo the latest one sent)
+	if (!has_echo || int32_t(sent - echo) > 0) {
+		echo = sent;
+		echo_received = time;
+		has_echo = true;
+	}
+
+	if (int32_t(their_remote_end - acked) > 0 && their_remote_end <= local_end) acked = their_remote_end;
+	remote_checked = std::max(remote_checked, their_checked);
+
+	for (uint32_t u = first; u < first + count; ++u) {
+		Input in;
+		in.value = from.get_float();
+		in.restart = uint8_t(from.get(1));
+		if (!from.ok) return;
+		//(take the inputs that extend what is here, as long as there's room for them)
+		if (u == remote_end && remote_end - update < window) {
+			remote_inputs[u % window] = in;
+			remote_end += 1;
+		}
+	}
+
+	uint32_t checksums = uint32_t(from.get(1));
+	for (uint32_t i = 0; i < checksums; ++i) {
+		uint32_t u = uint32_t(from.get(4));
+		uint64_t value = from.get(8);
+		if (!from.ok) return;
+		//(skip checksums for updates so long ago that their local checksums are gone)
+		if (u + window <= update) continue;
+		Checksum &c = remote_checksums[u % window];
+		c.update = u;
+		c.value = value;
+		compare(u);
+	}
+}
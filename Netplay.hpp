@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CounterRng.hpp"
+
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * Netplay runs two-player games in deterministic lockstep over UDP: each peer
+ * has its own copy of the game, plays one paddle, and sends only that paddle's
+ * inputs to the other peer. An update runs only once both players' inputs for
+ * it are in, so (since SnakeSim is deterministic) both copies stay the same.
+ *
+ * Input is scheduled 'delay' updates ahead, to give it time to get to the other
+ * peer before it is needed. The delay follows the measured round trip time.
+ *
+ * Every packet carries every input the other peer hasn't acknowledged yet (so a
+ * lost packet is covered by the next one), along with checksums of the last few
+ * updates, which are compared against the local game's to catch desyncs.
+ *
+ * Outgoing packets can also be dropped or held back on purpose, to try things
+ * out on loopback under loss and latency.
+ *
+ * Netplay has no game logic of its own: the caller runs the game, e.g.:
+ *   net.poll();
+ *   net.schedule(my_input);
+ *   if (net.ready()) {
+ *     ...apply net.input(Left) and net.input(Right), update the game...
+ *     net.advance(sim.checksum(0));
+ *   }
+ */
+
+struct Netplay {
+	enum Side : uint8_t {
+		Left = 0, //plays the left paddle (keyboard)
+		Right = 1, //plays the right paddle (mouse)
+	};
+
+	//one player's input for one update:
+	struct Input {
+		float value = 0.0f; //SnakeSim::left_input (as -1, 0, or +1) for Left, right_paddle y for Right
+		uint8_t restart = 0; //start a new game (if the current one is over)
+	};
+
+	//sends to and receives from 'remote_host':'remote_port' on UDP port 'local_port';
+	// 'session' (e.g., the game seed) must match the other peer's, and 'tick' is seconds per update:
+	//NOTE: throws on error
+	Netplay(Side side, uint16_t local_port, std::string const &remote_host, uint16_t remote_port, uint32_t session, float tick);
+	~Netplay();
+	Netplay(Netplay const &) = delete;
+	Netplay &operator=(Netplay const &) = delete;
+
+	Side side;
+	uint32_t session;
+	float tick;
+
+	//the next update to run (updates run so far):
+	uint32_t update = 0;
+
+	//receives any packets that have come in and sends one if it's time (call often -- every frame, or more):
+	void poll();
+	//schedules the local player's input up to update + delay (call before ready() each time an update is due):
+	// returns true if 'input' was used for any update (so, e.g., a one-off restart request can be cleared)
+	bool schedule(Input const &input);
+	//are both players' inputs in for 'update'?
+	bool ready() const;
+	//the inputs for 'update' (only if ready()):
+	Input input(Side player) const;
+	//call after running 'update' with the game's checksum after it:
+	void advance(uint64_t checksum);
+
+	//----- status -----
+	uint32_t delay; //updates of input delay currently used for the local player's input
+	float rtt = 0.0f; //smoothed round trip time (seconds; zero until measured)
+	float rtt_deviation = 0.0f; //smoothed mean deviation of round trip time
+	uint32_t checked = 0; //updates whose checksums have been compared with the other peer's
+	uint32_t desyncs = 0; //...and how many of those didn't match
+	uint32_t first_desync = 0; //(update of the first mismatch, if any)
+	uint32_t remote_checked = 0; //'checked' as last reported by the other peer
+	uint32_t packets_sent = 0, packets_received = 0, packets_dropped = 0; //(dropped on purpose -- see 'loss')
+	//seconds since a packet arrived from the other peer (or since starting, if none has):
+	float silence() const;
+
+	//----- simulated network conditions (outgoing packets) -----
+	float loss = 0.0f; //chance to drop each packet
+	float latency = 0.0f; //seconds to hold each packet before sending
+	float jitter = 0.0f; //...plus up to this much more, at random (so packets can arrive out of order)
+
+	//(internals)
+	static constexpr uint32_t min_delay = 1, max_delay = 15;
+	static constexpr uint32_t window = 256; //updates of input and checksums kept (must be more than unacknowledged inputs can span)
+	static constexpr uint32_t max_batch = 64; //most inputs sent per packet
+	static constexpr uint32_t sent_checksums = 8; //checksums of this many recent updates go in each packet
+
+	uintptr_t socket; //(SOCKET or file descriptor)
+	std::array< uint8_t, 128 > remote_address; //(sockaddr)
+	uint32_t remote_address_size = 0;
+
+	//inputs by update (index update % window):
+	std::array< Input, window > local_inputs, remote_inputs;
+	uint32_t local_end = 0; //local input is scheduled for updates before this
+	uint32_t remote_end = 0; //remote input is in for updates before this
+	uint32_t acked = 0; //the other peer has local input for updates before this
+
+	//checksums by update (index update % window):
+	struct Checksum {
+		uint32_t update = 0xffffffffu;
+		uint64_t value = 0;
+		bool compared = false; //(local checksums only -- redundant copies of a remote checksum are only compared once)
+	};
+	std::array< Checksum, window > local_checksums, remote_checksums;
+	void compare(uint32_t update);
+
+	//times are in milliseconds since the start:
+	uint32_t now() const;
+	uint64_t start;
+	uint32_t last_send = 0;
+	uint32_t last_heard = 0;
+	uint32_t echo = 0; //latest send time from the other peer...
+	uint32_t echo_received = 0; //...and when it arrived here
+	bool has_echo = false;
+
+	void send();
+	void receive(uint8_t const *data, size_t size);
+
+	//packets held back to simulate latency:
+	struct Held {
+		uint32_t release;
+		std::vector< uint8_t > data;
+	};
+	std::deque< Held > held;
+	CounterRng rng;
+	void transmit(std::vector< uint8_t > const &data);
+};
@@ -0,0 +1,86 @@
+#include "OccupancyGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+OccupancyGrid::OccupancyGrid(glm::vec2 const &min_, glm::vec2 const &max_, float cell_size_, float reach_) : min(min_), reach(reach_) {
+	assert(cell_size_ > 0.0f && max_.x > min_.x && max_.y > min_.y);
+	size.x = std::max(1, int(std::ceil((max_.x - min_.x) / cell_size_)));
+	size.y = std::max(1, int(std::ceil((max_.y - min_.y) / cell_size_)));
+	//shrink cells slightly so the grid covers exactly [min, max]:
+	cell_size = glm::vec2((max_.x - min_.x) / size.x, (max_.y - min_.y) / size.y);
+	//(cell indices are stored as uint16_t)
+	assert(size.x * size.y <= 0x10000);
+	blocked.resize(size.x * size.y);
+	slot.resize(size.x * size.y);
+	clear();
+}
+
+void OccupancyGrid::clear() {
+	version += 1;
+	std::fill(blocked.begin(), blocked.end(), uint16_t(0));
+	free.resize(blocked.size());
+	for (size_t c = 0; c < blocked.size(); ++c) {
+		free[c] = uint16_t(c);
+		slot[c] = uint16_t(c);
+	}
+}
+
+template< typename Fn >
+void OccupancyGrid::for_cells(glm::vec2 const &a, glm::vec2 const &b, Fn const &fn) const {
+	//a cell is within reach if its center is within reach + (half its diagonal), which is a little conservative:
+	glm::vec2 half = 0.5f * cell_size;
+	float within = reach + std::sqrt(half.x * half.x + half.y * half.y);
+
+	glm::vec2 lo = (glm::min(a, b) - glm::vec2(within) - min) / cell_size;
+	glm::vec2 hi = (glm::max(a, b) + glm::vec2(within) - min) / cell_size;
+	int x0 = std::max(int(std::floor(lo.x)), 0), x1 = std::min(int(std::floor(hi.x)), size.x - 1);
+	int y0 = std::max(int(std::floor(lo.y)), 0), y1 = std::min(int(std::floor(hi.y)), size.y - 1);
+
+	glm::vec2 ab = b - a;
+	float len2 = ab.x * ab.x + ab.y * ab.y;
+	float inv_len2 = (len2 > 0.0f ? 1.0f / len2 : 0.0f);
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			glm::vec2 center = min + (glm::vec2(x, y) + 0.5f) * cell_size;
+			glm::vec2 ap = center - a;
+			float t = std::min(std::max((ap.x * ab.x + ap.y * ab.y) * inv_len2, 0.0f), 1.0f);
+			glm::vec2 e = ap - t * ab;
+			if (e.x * e.x + e.y * e.y < within * within) fn(y * size.x + x);
+		}
+	}
+}
+
+void OccupancyGrid::add(glm::vec2 const &a, glm::vec2 const &b) {
+	version += 1;
+	for_cells(a, b, [this](int c){
+		if (blocked[c]++ == 0) {
+			//swap-remove c from the free list:
+			uint16_t last = free.back();
+			free[slot[c]] = last;
+			slot[last] = slot[c];
+			free.pop_back();
+		}
+	});
+}
+
+void OccupancyGrid::remove(glm::vec2 const &a, glm::vec2 const &b) {
+	version += 1;
+	for_cells(a, b, [this](int c){
+		assert(blocked[c] > 0);
+		if (--blocked[c] == 0) {
+			slot[c] = uint16_t(free.size());
+			free.emplace_back(uint16_t(c));
+		}
+	});
+}
+
+glm::vec2 OccupancyGrid::sample(CounterRng &rng) const {
+	glm::vec2 offset = glm::vec2(rng.uniform(), rng.uniform());
+	if (free.empty()) {
+		return min + offset * (cell_size * glm::vec2(size));
+	}
+	uint32_t c = free[uint32_t((uint64_t(rng()) * free.size()) >> 32)];
+	return min + (glm::vec2(c % size.x, c / size.x) + offset) * cell_size;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CounterRng.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * OccupancyGrid tracks which cells of a rectangle are clear of a set of line
+ * segments, so a random clear spot can be picked in constant time (used to
+ * spawn fruit away from the snake's body).
+ *
+ * Each cell counts the segments that come within 'reach' of any part of it;
+ * cells with a zero count are kept in a dense 'free' list (with each cell's
+ * position in that list, so cells can be added and removed in O(1)).
+ * Adding or removing a segment only touches the cells near that segment.
+ */
+
+struct OccupancyGrid {
+	//grid covering [min, max] with cells no larger than 'cell_size'; segments block cells within 'reach' of them:
+	OccupancyGrid(glm::vec2 const &min, glm::vec2 const &max, float cell_size, float reach);
+
+	void add(glm::vec2 const &a, glm::vec2 const &b);
+	//'a' and 'b' must be the same endpoints the segment was added with:
+	void remove(glm::vec2 const &a, glm::vec2 const &b);
+	void clear();
+
+	//number of unblocked cells:
+	size_t free_count() const { return free.size(); }
+	//a uniformly random point in a uniformly chosen unblocked cell (anywhere in [min, max] if all are blocked):
+	glm::vec2 sample(CounterRng &rng) const;
+
+	glm::vec2 min;
+	glm::vec2 cell_size;
+	glm::ivec2 size; //number of cells in x and y
+	float reach;
+	std::vector< uint16_t > blocked; //number of segments blocking each cell
+	std::vector< uint16_t > free; //indices of cells with blocked == 0, in no particular order
+	std::vector< uint16_t > slot; //slot[c] is the index of cell c in 'free' (only meaningful while it is free)
+	uint32_t version = 0; //changes whenever 'free' might have (so copies of it can be told apart)
+
+	//calls 'fn(int cell_index)' for each cell within 'reach' of the segment:
+	template< typename Fn >
+	void for_cells(glm::vec2 const &a, glm::vec2 const &b, Fn const &fn) const;
+};
@@ -0,0 +1,96 @@
+#include "PaddleBot.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr float PaddleBot::max_aim;
+constexpr uint32_t PaddleBot::rng_stream;
+
+PaddleBot::PaddleBot(uint32_t seed, float right_speed_) : right_speed(right_speed_), rng(seed, rng_stream) {
+}
+
+float PaddleBot::crossing(glm::vec2 const &from, glm::vec2 const &velocity, float plane, float wall, float *arrival, float *velocity_y) {
+	*velocity_y = velocity.y;
+	if (velocity.x == 0.0f) {
+		*arrival = std::numeric_limits< float >::infinity();
+		return from.y;
+	}
+	*arrival = std::max((plane - from.x) / velocity.x, 0.0f);
+	//fold the straight-line y back into the court (reflections off walls at +/- wall; every other fold runs backward):
+	float y = std::fmod(from.y + velocity.y * *arrival + wall, 4.0f * wall);
+	if (y < 0.0f) y += 4.0f * wall;
+	if (y > 2.0f * wall) {
+		y = 4.0f * wall - y;
+		*velocity_y = -velocity.y;
+	}
+	return y - wall;
+}
+
+void PaddleBot::re_aim(SnakeSim const &sim, size_t g) {
+	if ((sim.snake_velocity[g].x > 0.0f) != (heading > 0.0f)) {
+		heading = sim.snake_velocity[g].x;
+		aim = (2.0f * rng.uniform() - 1.0f) * max_aim * SnakeSim::paddle_size.y;
+	}
+}
+
+PaddleBot::Targets PaddleBot::targets(SnakeSim const &sim, size_t g) {
+	glm::vec2 const reach = SnakeSim::paddle_size + SnakeSim::snake_size;
+	glm::vec2 const wall = sim.config.court_size - SnakeSim::snake_size;
+	float const limit = sim.config.court_size.y - SnakeSim::paddle_size.y; //(paddles stop here)
+
+	float speed = sim.head_speed(g);
+	glm::vec2 head = sim.snake_vertices[g][0];
+	glm::vec2 velocity = speed * sim.snake_velocity[g];
+	bool leftward = velocity.x < 0.0f;
+	float near_plane = (leftward ? sim.left_paddle[g].x + reach.x : sim.right_paddle[g].x - reach.x);
+	float far_plane = (leftward ? sim.right_paddle[g].x - reach.x : sim.left_paddle[g].x + reach.x);
+
+	//the paddle the head is heading for:
+	float near_arrival, near_velocity_y;
+	float near_y = crossing(head, velocity, near_plane, wall.y, &near_arrival, &near_velocity_y);
+	float near_target = std::min(std::max(near_y - aim, -limit), limit);
+
+	//...and the other one, after the head bounces off the first:
+	glm::vec2 bounce = glm::vec2(near_plane, near_y);
+	glm::vec2 bounce_velocity = glm::vec2(-velocity.x, near_velocity_y);
+	float offset = (near_y - near_target) / reach.y;
+	if (std::abs(offset) <= 1.0f) {
+		//warp y velocity based on offset from paddle center (as in SnakeSim::update, where velocity is per unit of speed):
+		bounce_velocity.y = speed * glm::mix(near_velocity_y / speed, offset, 0.75f);
+	} else {
+		//(can't get there -- the head will bounce off the wall behind the paddle instead)
+		bounce.x = (leftward ? -wall.x : wall.x);
+		bounce.y = crossing(head, velocity, bounce.x, wall.y, &near_arrival, &bounce_velocity.y);
+	}
+	float far_arrival, far_velocity_y;
+	float far_y = crossing(bounce, bounce_velocity, far_plane, wall.y, &far_arrival, &far_velocity_y);
+	float far_target = std::min(std::max(far_y, -limit), limit);
+
+	Targets t;
+	t.left = (leftward ? near_target : far_target);
+	t.right = (leftward ? far_target : near_target);
+	t.left_arrival = (leftward ? near_arrival : near_arrival + far_arrival);
+	t.right_arrival = (leftward ? near_arrival + far_arrival : near_arrival);
+	return t;
+}
+
+PaddleBot::Decision PaddleBot::decide(SnakeSim const &sim, size_t g, float elapsed) {
+	re_aim(sim, g);
+	Targets t = targets(sim, g);
+
+	Decision d;
+	//left paddle: hold W or S until it is within a step of the target:
+	float dy = t.left - sim.left_paddle[g].y;
+	d.left_input = (dy > SnakeSim::paddle_step ? 1 : (dy < -SnakeSim::paddle_step ? -1 : 0));
+	//right paddle: move the mouse toward the target, but only so fast:
+	float most = right_speed * elapsed;
+	float right = sim.right_paddle[g].y;
+	d.right_paddle = right + std::min(std::max(t.right - right, -most), most);
+	return d;
+}
+
+void PaddleBot::play(SnakeSim &sim, size_t g, float elapsed) {
+	Decision d = decide(sim, g, elapsed);
+	sim.left_input[g] = d.left_input;
+	sim.right_paddle[g].y = d.right_paddle;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "SnakeSim.hpp"
+#include "CounterRng.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+
+/*
+ * PaddleBot plays both paddles of one SnakeSim game, so headless runs (and
+ * 'pong --autoplay') don't need scripted input.
+ *
+ * It predicts where the head will cross each paddle's face. Bounces off the
+ * top and bottom walls are mirror images of the straight-line path, so the
+ * head's y at any time is the straight-line y folded back into the court --
+ * no stepping. The paddle the head is heading for is moved to the predicted
+ * crossing; the other paddle goes to where the head will cross it after
+ * bouncing off the first (using the same y warp as SnakeSim::update).
+ *
+ * The bot aims to hit the head a random distance from the paddle's center
+ * (re-picked every bounce), so the snake goes off at angles like it would for
+ * a player. Like a player, it can only move the left paddle by holding a key
+ * (paddle_step per update), and the right (mouse) paddle only so fast.
+ */
+
+struct PaddleBot {
+	//'seed' picks the bot's aim (from its own CounterRng stream, so the game's stream isn't disturbed):
+	explicit PaddleBot(uint32_t seed = 0, float right_speed = std::numeric_limits< float >::infinity());
+
+	//fastest the right paddle moves (units per second; infinity just puts it at the target):
+	float right_speed;
+
+	//the input for one update of game g:
+	struct Decision {
+		int8_t left_input;
+		float right_paddle; //y
+	};
+	Decision decide(SnakeSim const &sim, size_t g, float elapsed);
+	//decide, then apply it to the game:
+	void play(SnakeSim &sim, size_t g, float elapsed);
+
+	//where each paddle should be (y), and how long (seconds) until the head gets to it:
+	struct Targets {
+		float left, right;
+		float left_arrival, right_arrival;
+	};
+	Targets targets(SnakeSim const &sim, size_t g);
+
+	//where (in y) a head moving from 'from' with 'velocity' (units per second) will cross x = 'plane',
+	// bouncing off walls at y = +/- 'wall'; sets 'arrival' to when and 'velocity_y' to its y velocity then:
+	static float crossing(glm::vec2 const &from, glm::vec2 const &velocity, float plane, float wall, float *arrival, float *velocity_y);
+
+	//(internals)
+	//bots aim to hit the snake this far (at most, as a fraction of the paddle's half-height) from the paddle's center:
+	static constexpr float max_aim = 0.8f;
+	//CounterRng stream used for bots (games use stream zero):
+	static constexpr uint32_t rng_stream = 1;
+	CounterRng rng;
+	float aim = 0.0f; //offset of the head from the paddle center the bot is going for
+	float heading = 0.0f; //x direction the aim was picked for (re-aim after each bounce)
+	void re_aim(SnakeSim const &sim, size_t g);
+};
@@ -3,72 +3,111 @@
 //for the GL_ERRORS() macro:
 #include "gl_errors.hpp"
 
+//drawing sets OpenGL state through this, so calls that change nothing are skipped:
+#include "GLState.hpp"
+
+//for the corners of the snake's quads:
+#include "segment_quads.hpp"
+
 //for glm::value_ptr() :
 #include <glm/gtc/type_ptr.hpp>
 
-#include <random>
-#include <deque>
+#include <iostream>
+#include <cmath>
 	   
-PongMode::PongMode() {
-	// initial setup of game
-	setup();
-	
+PongMode::PongMode(uint32_t seed) : sim(1, seed), bot(seed), history(sim, 0) {
+	replay.seed = seed;
+	replay.elapsed = Mode::tick;
+
 	//----- allocate OpenGL resources -----
-	{ //vertex buffer:
-		glGenBuffers(1, &vertex_buffer);
-		//for now, buffer will be un-filled.
+	{ //vertex array objects mapping each layer's buffer for color_texture_program (and rects_buffer and quads_buffer for their programs):
+		for (Layer *layer : {&static_layer, &hud_layer, &dynamic_layer, &snake_layer}) {
+			//ask OpenGL to fill layer->vertex_array with the name of an unused vertex array object:
+			glGenVertexArrays(1, &layer->vertex_array);
+
+			//set layer->vertex_array as the current vertex array object:
+			glBindVertexArray(layer->vertex_array);
+
+			//set the layer's buffer as the source of glVertexAttribPointer() commands:
+			glBindBuffer(GL_ARRAY_BUFFER, layer->buffer.buffer);
+
+			//set up the vertex array object to describe arrays of PongMode::Vertex:
+			glVertexAttribPointer(
+				color_texture_program.Position_vec4, //attribute
+				3, //size
+				GL_FLOAT, //type
+				GL_FALSE, //normalized
+				sizeof(Vertex), //stride
+				(GLbyte *)0 + 0 //offset
+			);
+			glEnableVertexAttribArray(color_texture_program.Position_vec4);
+			//[Note that it is okay to bind a vec3 input to a vec4 attribute -- the w component will be filled with 1.0 automatically]
+
+			glVertexAttribPointer(
+				color_texture_program.Color_vec4, //attribute
+				4, //size
+				GL_UNSIGNED_BYTE, //type
+				GL_TRUE, //normalized
+				sizeof(Vertex), //stride
+				(GLbyte *)0 + 4*3 //offset
+			);
+			glEnableVertexAttribArray(color_texture_program.Color_vec4);
+
+			glVertexAttribPointer(
+				color_texture_program.TexCoord_vec2, //attribute
+				2, //size
+				GL_FLOAT, //type
+				GL_FALSE, //normalized
+				sizeof(Vertex), //stride
+				(GLbyte *)0 + 4*3 + 4*1 //offset
+			);
+			glEnableVertexAttribArray(color_texture_program.TexCoord_vec2);
+		}
+
+		//rects_vertex_array maps rects_buffer for rect_instance_program, advancing one Rect per instance
+		// (the program makes the corners itself, so nothing advances per vertex):
+		glGenVertexArrays(1, &rects_vertex_array);
+		glBindVertexArray(rects_vertex_array);
+		glBindBuffer(GL_ARRAY_BUFFER, rects_buffer.buffer);
+		auto instance_attribute = [](GLuint attribute, GLint size, GLenum type, GLboolean normalized, size_t offset) {
+			glVertexAttribPointer(attribute, size, type, normalized, sizeof(Rect), (GLbyte *)0 + offset);
+			glEnableVertexAttribArray(attribute);
+			glVertexAttribDivisor(attribute, 1);
+		};
+		instance_attribute(rect_instance_program.Center_vec2, 2, GL_FLOAT, GL_FALSE, 0);
+		instance_attribute(rect_instance_program.Radius_vec2, 2, GL_FLOAT, GL_FALSE, 4*2);
+		instance_attribute(rect_instance_program.Angle_float, 1, GL_FLOAT, GL_FALSE, 4*2 + 4*2);
+		instance_attribute(rect_instance_program.Color_vec4, 4, GL_UNSIGNED_BYTE, GL_TRUE, 4*2 + 4*2 + 4);
+
+		//quads_vertex_array maps quads_buffer for color_program, and fetches indices from quad_indices:
+		glGenVertexArrays(1, &quads_vertex_array);
+		glBindVertexArray(quads_vertex_array);
+		glBindBuffer(GL_ARRAY_BUFFER, quads_buffer.buffer);
+		glVertexAttribPointer(color_program.Position_vec4, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (GLbyte *)0 + 0);
+		glEnableVertexAttribArray(color_program.Position_vec4);
+		glVertexAttribPointer(color_program.Color_vec4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadVertex), (GLbyte *)0 + 4*2);
+		glEnableVertexAttribArray(color_program.Color_vec4);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quad_indices.buffer);
+
+		//done referring to the buffers, so unbind them:
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		//done setting up vertex array objects, so unbind them:
+		glBindVertexArray(0);
 
 		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
 	}
 
-	{ //vertex array mapping buffer for color_texture_program:
-		//ask OpenGL to fill vertex_buffer_for_color_texture_program with the name of an unused vertex array object:
-		glGenVertexArrays(1, &vertex_buffer_for_color_texture_program);
-
-		//set vertex_buffer_for_color_texture_program as the current vertex array object:
-		glBindVertexArray(vertex_buffer_for_color_texture_program);
-
-		//set vertex_buffer as the source of glVertexAttribPointer() commands:
-		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-
-		//set up the vertex array object to describe arrays of PongMode::Vertex:
-		glVertexAttribPointer(
-			color_texture_program.Position_vec4, //attribute
-			3, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 0 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Position_vec4);
-		//[Note that it is okay to bind a vec3 input to a vec4 attribute -- the w component will be filled with 1.0 automatically]
-	   
-
-		glVertexAttribPointer(
-			color_texture_program.Color_vec4, //attribute
-			4, //size
-			GL_UNSIGNED_BYTE, //type
-			GL_TRUE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 4*3 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.Color_vec4);
-
-		glVertexAttribPointer(
-			color_texture_program.TexCoord_vec2, //attribute
-			2, //size
-			GL_FLOAT, //type
-			GL_FALSE, //normalized
-			sizeof(Vertex), //stride
-			(GLbyte *)0 + 4*3 + 4*1 //offset
-		);
-		glEnableVertexAttribArray(color_texture_program.TexCoord_vec2);
-
-		//done referring to vertex_buffer, so unbind it:
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	{ //buffer texture of the snake's vertices, for snake_program:
+		//(binding creates the buffer object, which glTexBuffer needs)
+		glBindBuffer(GL_TEXTURE_BUFFER, snake_polyline_buffer.buffer);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		glGenTextures(1, &snake_polyline_tex);
+		glBindTexture(GL_TEXTURE_BUFFER, snake_polyline_tex);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, snake_polyline_buffer.buffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
 
-		//done setting up vertex array object, so unbind it:
-		glBindVertexArray(0);
+		glGenVertexArrays(1, &empty_vertex_array);
 
 		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
 	}
@@ -100,62 +139,72 @@ PongMode::PongMode() {
 
 		GL_ERRORS(); //PARANOIA: print out any OpenGL errors that may have happened
 	}
+
+	//(the setup above bound things directly, so what gl_state remembers may be out of date)
+	gl_state.invalidate();
+
+	//nothing to interpolate from yet:
+	remember_state();
 }
 
 	   
 PongMode::~PongMode() {
+	save_replay();
 
 	//----- free OpenGL resources -----
-	glDeleteBuffers(1, &vertex_buffer);
-	vertex_buffer = 0;
+	//(layer, rect, and quad buffers free themselves)
+	for (Layer *layer : {&static_layer, &hud_layer, &dynamic_layer, &snake_layer}) {
+		glDeleteVertexArrays(1, &layer->vertex_array);
+		layer->vertex_array = 0;
+	}
+	glDeleteVertexArrays(1, &rects_vertex_array);
+	rects_vertex_array = 0;
+	glDeleteVertexArrays(1, &quads_vertex_array);
+	quads_vertex_array = 0;
 
-	glDeleteVertexArrays(1, &vertex_buffer_for_color_texture_program);
-	vertex_buffer_for_color_texture_program = 0;
+	glDeleteTextures(1, &snake_polyline_tex);
+	snake_polyline_tex = 0;
+	glDeleteVertexArrays(1, &empty_vertex_array);
+	empty_vertex_array = 0;
 
 	glDeleteTextures(1, &white_tex);
 	white_tex = 0;
-}
-
-void PongMode::setup() {
-	// Initialize snake position
-	snake_vertices.clear();
-	snake_vertices.emplace_back(glm::vec2(0.0f, 0.0f));
-	snake_vertices.emplace_back(glm::vec2(snake_length, 0.0f));
-
-	snake_velocity = glm::vec2(-1.0f, 0.0f);
-	snake_length = initial_snake_length;
-	length_update_buffer = 0.0f;
 
-	left_paddle = glm::vec2(-court_size.x + 0.5f, 0.0f);
-	right_paddle = glm::vec2(court_size.x - 0.5f, 0.0f);
-
-	// Generate initial green_fruit position
-	static std::mt19937 mt; //mersenne twister pseudo-random number generator
-
-	green_fruit.x = (mt() / float(mt.max()) * court_size.x - court_size.x) * 0.8;
-	green_fruit.y = (mt() / float(mt.max()) * court_size.y - court_size.y) * 0.8;
-
-    red_fruit_exists = false;
-
-	last_collided = false;
-	
-	health = initial_health;
-
-    running = true;
-}
-
-void PongMode::damaged(int damage) {
-	health -= damage;
-	if(health < 0) {
-        running = false;
-	}
+	//(deleting a bound object unbinds it, and its name can be reused)
+	gl_state.invalidate();
 }
 
 bool PongMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size) {
+	if (autoplay) return false;
+
+	if (netplay) {
+		//input is sent to the other player, and goes into the game once their input for the same update is in (see update):
+		if (!sim.running[0] && evt.type == SDL_KEYDOWN) {
+			netplay_restart = true;
+		} else if (evt.type == SDL_MOUSEMOTION) {
+			glm::vec2 clip_mouse = glm::vec2(
+				(evt.motion.x + 0.5f) / window_size.x * 2.0f - 1.0f,
+				(evt.motion.y + 0.5f) / window_size.y *-2.0f + 1.0f
+			);
+			netplay_paddle = (clip_to_court * glm::vec3(clip_mouse, 1.0f)).y;
+		} else if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_w) {
+			w_pressed = true;
+			s_pressed = false;
+		} else if (evt.type == SDL_KEYUP && evt.key.keysym.sym == SDLK_w) {
+			w_pressed = false;
+		} else if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_s) {
+			s_pressed = true;
+			w_pressed = false;
+		} else if (evt.type == SDL_KEYUP && evt.key.keysym.sym == SDLK_s) {
+			s_pressed = false;
+		}
+		return false;
+	}
 
-    if(!running) {
+    if(!sim.running[0]) {
         if(evt.type == SDL_KEYDOWN) {
-            setup();
+            input(Replay::Restart, 0.0f);
+            remember_state();
         }
     } else {
         if (evt.type == SDL_MOUSEMOTION) {
@@ -164,7 +213,10 @@ bool PongMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
                     (evt.motion.x + 0.5f) / window_size.x * 2.0f - 1.0f,
                     (evt.motion.y + 0.5f) / window_size.y *-2.0f + 1.0f
                     );
-            right_paddle.y = (clip_to_court * glm::vec3(clip_mouse, 1.0f)).y;
+            float right_paddle = (clip_to_court * glm::vec3(clip_mouse, 1.0f)).y;
+            if (right_paddle != sim.right_paddle[0].y) {
+                input(Replay::RightPaddle, right_paddle);
+            }
         } else if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_w) {
             w_pressed = true;
             s_pressed = false;
@@ -176,349 +228,482 @@ bool PongMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
         } else if (evt.type == SDL_KEYUP && evt.key.keysym.sym == SDLK_s) {
             s_pressed = false;
         }
+
+        //keyboard state drives the left paddle:
+        int8_t left_input = w_pressed ? 1 : (s_pressed ? -1 : 0);
+        if (left_input != sim.left_input[0]) {
+            input(Replay::LeftInput, left_input);
+        }
     }
 
 	return false;
 }
 	   
 
-// Inline helper function
-// not sure why vec.length() always returns 2
-static float inline veclength(glm::vec2 vector) {
-	return pow(vector.x * vector.x + vector.y * vector.y, 0.5);
+void PongMode::remember_state() {
+	RingBuffer< glm::vec2 > const &snake_vertices = sim.snake_vertices[0];
+	prev_left_paddle = sim.left_paddle[0];
+	prev_head = snake_vertices.front();
+	prev_tail = snake_vertices.back();
+	prev_neck = snake_vertices[snake_vertices.size() > 1 ? 1 : 0];
+	prev_head_serial = sim.head_serial[0];
+	prev_tail_serial = sim.head_serial[0] - uint32_t(snake_vertices.size() - 1);
+}
+
+void PongMode::input(Replay::Type type, float value) {
+	if (replay_filename.empty()) Replay::apply(sim, 0, type, value);
+	else replay.record(sim, 0, type, value);
+}
+
+void PongMode::save_replay() {
+	if (replay_filename.empty()) return;
+	replay.checksum = sim.checksum(0);
+	try {
+		replay.save(replay_filename);
+	} catch (std::exception const &e) {
+		std::cerr << "Failed to save replay: " << e.what() << std::endl;
+	}
 }
 
 void PongMode::update(float elapsed) {
-    if(!running) return;
+	if (netplay) {
+		netplay->poll();
+		Netplay::Input mine;
+		if (autoplay) {
+			PaddleBot::Decision d = bot.decide(sim, 0, elapsed);
+			mine.value = (netplay->side == Netplay::Left ? float(d.left_input) : d.right_paddle);
+			mine.restart = !sim.running[0];
+		} else {
+			mine.value = (netplay->side == Netplay::Left ? float(w_pressed ? 1 : (s_pressed ? -1 : 0)) : netplay_paddle);
+			mine.restart = netplay_restart;
+		}
+		if (netplay->schedule(mine)) netplay_restart = false;
+		//lockstep: hold at the latest update until the other player's input for the next one is in:
+		if (!netplay->ready()) return;
+
+		//both players' inputs go through the replay:
+		Netplay::Input left = netplay->input(Netplay::Left);
+		Netplay::Input right = netplay->input(Netplay::Right);
+		if (!sim.running[0] && (left.restart || right.restart)) input(Replay::Restart, 0.0f);
+		if (int8_t(left.value) != sim.left_input[0]) input(Replay::LeftInput, left.value);
+		if (right.value != sim.right_paddle[0].y) input(Replay::RightPaddle, right.value);
+	} else if (autoplay) {
+		//the bot's inputs go through the replay like a player's would:
+		if (!sim.running[0]) input(Replay::Restart, 0.0f);
+		PaddleBot::Decision d = bot.decide(sim, 0, elapsed);
+		if (d.left_input != sim.left_input[0]) input(Replay::LeftInput, d.left_input);
+		if (d.right_paddle != sim.right_paddle[0].y) input(Replay::RightPaddle, d.right_paddle);
+	}
 
-	static std::mt19937 mt; //mersenne twister pseudo-random number generator
+	remember_state();
 
-    if(w_pressed) {
-        left_paddle.y += 0.2f;
-    } else if(s_pressed) {
-        left_paddle.y -= 0.2f;
-    }
+	bool was_running = sim.running[0];
+	sim.update(elapsed);
+	replay.updates += 1;
+	history.save(sim);
 
-	left_paddle.y = std::min(left_paddle.y, court_size.y - paddle_size.y);
-	left_paddle.y = std::max(left_paddle.y, -court_size.y + paddle_size.y);
-	right_paddle.y = std::min(right_paddle.y, court_size.y - paddle_size.y);
-	right_paddle.y = std::max(right_paddle.y, -court_size.y + paddle_size.y);
+	if (netplay) {
+		netplay->advance(sim.checksum(0));
+		if (netplay->desyncs != netplay_desyncs) {
+			if (netplay_desyncs == 0) {
+				std::cerr << "Netplay: this game no longer matches the other player's (as of update " << netplay->first_desync << ")." << std::endl;
+			}
+			netplay_desyncs = netplay->desyncs;
+		}
+	}
+
+	if (was_running && !sim.running[0]) {
+		save_replay();
+	}
+}
+
+// helper function for rectangle drawing:
+// (corners go around the rectangle counterclockwise; it is drawn as the triangles 0 1 2 and 0 2 3)
+static void rectangle_corners(glm::vec2 const &center, glm::vec2 const &size, glm::vec2 corners[4]) {
+	corners[0] = glm::vec2(center.x-size.x, center.y-size.y);
+	corners[1] = glm::vec2(center.x+size.x, center.y-size.y);
+	corners[2] = glm::vec2(center.x+size.x, center.y+size.y);
+	corners[3] = glm::vec2(center.x-size.x, center.y+size.y);
+}
+
+// a quad as two CCW-oriented triangles:
+static void draw_quad(std::vector< PongMode::Vertex > &vertices, glm::vec2 const corners[4], glm::u8vec4 const &color) {
+	for (uint32_t i : {0, 1, 2, 0, 2, 3}) {
+		vertices.emplace_back(glm::vec3(corners[i], 0.0f), color, glm::vec2(0.5f, 0.5f));
+	}
+}
+
+// ...or as just its corners (for drawing through PongMode::quad_indices):
+static void draw_quad(std::vector< PongMode::QuadVertex > &vertices, glm::vec2 const corners[4], glm::u8vec4 const &color) {
+	for (uint32_t i = 0; i < 4; ++i) {
+		vertices.emplace_back(corners[i], color);
+	}
+}
 
-	//----- snake head update -----
+// the same, written in place (into room already made for quad_size vertices):
+static constexpr size_t quad_size(std::vector< PongMode::Vertex > const &) { return 6; }
+static void put_quad(PongMode::Vertex *out, glm::vec2 const corners[4], glm::u8vec4 const &color) {
+	for (uint32_t i : {0, 1, 2, 0, 2, 3}) {
+		*(out++) = PongMode::Vertex(glm::vec3(corners[i], 0.0f), color, glm::vec2(0.5f, 0.5f));
+	}
+}
 
-	// speed of snake scales proportionally with snake length
-	float speed_multiplier = 2.0f + 0.5f * snake_length;
+static constexpr size_t quad_size(std::vector< PongMode::QuadVertex > const &) { return 4; }
+static void put_quad(PongMode::QuadVertex *out, glm::vec2 const corners[4], glm::u8vec4 const &color) {
+	for (uint32_t i = 0; i < 4; ++i) {
+		out[i] = PongMode::QuadVertex(corners[i], color);
+	}
+}
 
-	//velocity cap, this time for balance reasons
-	speed_multiplier = std::min(speed_multiplier, 7.5f);
+template< typename List >
+static void draw_rectangle(List &list, glm::vec2 const &center,
+		glm::vec2 const &size, glm::u8vec4 const &color) {
+	glm::vec2 corners[4];
+	rectangle_corners(center, size, corners);
+	draw_quad(list, corners, color);
+}
 
-	glm::vec2 movement = elapsed * speed_multiplier * snake_velocity;
-	snake_vertices[0] += movement;
-	float move_length = veclength(movement);
+template< typename List >
+static void draw_unaligned_rectangle(List &list, glm::vec2 const &vertex1,
+		glm::vec2 const &vertex2, glm::vec2 const &size,
+		glm::u8vec4 const &color) {
+	glm::vec2 corners[4];
+	segment_quad(vertex1, vertex2, size, corners);
+	draw_quad(list, corners, color);
+}
 
-	// Check if the length has increased first
-	if(move_length > length_update_buffer) {
-		move_length -= length_update_buffer;
-		length_update_buffer = 0.0f;
+// the same rectangles as instances (one Rect each -- see RectInstanceProgram):
+static void draw_rectangle(std::vector< PongMode::Rect > &rects, glm::vec2 const &center,
+		glm::vec2 const &size, glm::u8vec4 const &color) {
+	rects.emplace_back(PongMode::Rect{center, size, 0.0f, color});
+}
 
-		// trim end of snake
-		glm::vec2 end = snake_vertices.back();
-		snake_vertices.pop_back();
-		glm::vec2 penult = snake_vertices.back();
+static void draw_unaligned_rectangle(std::vector< PongMode::Rect > &rects, glm::vec2 const &vertex1,
+		glm::vec2 const &vertex2, glm::vec2 const &size,
+		glm::u8vec4 const &color) {
+	glm::vec2 along = vertex2 - vertex1;
+	rects.emplace_back(PongMode::Rect{0.5f * (vertex1 + vertex2), glm::vec2(0.5f * glm::length(along) + size.x, size.y),
+		std::atan2(along.y, along.x), color});
+}
 
-		while(true) {
-			float length = veclength(penult - end);
+// parts of the scene, built with whichever of the above fit 'List':
+template< typename List >
+static void draw_walls(List &list, glm::vec2 const &court_size, float wall_radius,
+		glm::vec2 const &offset, glm::u8vec4 const &color) {
+	draw_rectangle(list, glm::vec2(-court_size.x-wall_radius, 0.0f)+offset, glm::vec2(wall_radius, court_size.y + 2.0f * wall_radius), color);
+	draw_rectangle(list, glm::vec2( court_size.x+wall_radius, 0.0f)+offset, glm::vec2(wall_radius, court_size.y + 2.0f * wall_radius), color);
+	draw_rectangle(list, glm::vec2( 0.0f,-court_size.y-wall_radius)+offset, glm::vec2(court_size.x, wall_radius), color);
+	draw_rectangle(list, glm::vec2( 0.0f, court_size.y+wall_radius)+offset, glm::vec2(court_size.x, wall_radius), color);
+}
 
-			// if movement is larger than snake segment, remove it completely
-			if(move_length > length) {
-				move_length -= length;
-				end = snake_vertices.back();
-				snake_vertices.pop_back();
-				penult = snake_vertices.back();;
-			} else {
-				end += (penult - end) * move_length / length;
-				snake_vertices.push_back(end);
-				break;
-			}
-		}
-	} else {
-		// can skip trimming snake
-		length_update_buffer -= move_length;
-		move_length = 0.0f;
+template< typename List >
+static void draw_hearts(List &list, int health, glm::vec2 const &court_size, float wall_radius,
+		glm::u8vec4 const &color) {
+	for (int i = 0; i < health; i++) {
+		glm::vec2 pos = glm::vec2(-court_size.x + 0.5f + 1.0f * i,
+				court_size.y + 0.3f + 2.0f * wall_radius);
+		glm::vec2 offset1 = glm::vec2(-0.2f, 0.2f);
+		glm::vec2 offset2 = glm::vec2(0.2f, 0.2f);
+		draw_unaligned_rectangle(list, pos + offset1, pos, glm::vec2(0.2f, 0.2f), color);
+		draw_unaligned_rectangle(list, pos + offset2, pos, glm::vec2(0.2f, 0.2f), color);
 	}
+}
 
-	//---- collision handling ----
-
-	//paddles:
-	auto paddle_vs_head = [this](glm::vec2 const &paddle) {
-		//compute area of overlap:
-		glm::vec2 min = glm::max(paddle - paddle_size,
-				snake_vertices[0] - snake_size);
-		glm::vec2 max = glm::min(paddle + paddle_size,
-				snake_vertices[0] + snake_size);
-
-		//if no overlap, no collision:
-		if (min.x > max.x || min.y > max.y) return;
-
-		if (max.x - min.x > max.y - min.y) {
-			//wider overlap in x => bounce in y direction:
-			if (snake_vertices[0].y > paddle.y) {
-				snake_vertices[0].y = paddle.y + paddle_size.y + snake_size.y;
-				snake_vertices.push_front(glm::vec2(snake_vertices[0]));
-				snake_velocity.y = std::abs(snake_velocity.y);
-			} else {
-				snake_vertices[0].y = paddle.y - paddle_size.y - snake_size.y;
-				snake_vertices.push_front(glm::vec2(snake_vertices[0]));
-				snake_velocity.y = -std::abs(snake_velocity.y);
-			}
-		} else {
-			//wider overlap in y => bounce in x direction:
-			if (snake_vertices[0].x > paddle.x) {
-				snake_vertices[0].x = paddle.x + paddle_size.x + snake_size.x;
-				snake_vertices.push_front(glm::vec2(snake_vertices[0]));
-				snake_velocity.x = std::abs(snake_velocity.x);
-			} else {
-				snake_vertices[0].x = paddle.x - paddle_size.x - snake_size.x;
-				snake_vertices.push_front(glm::vec2(snake_vertices[0]));
-				snake_velocity.x = -std::abs(snake_velocity.x);
+//(walks the contiguous runs of the vertex ring, carrying the previous vertex across; the ends are drawn at 'head' and 'tail')
+template< typename List >
+static void draw_snake(List &list, RingBuffer< glm::vec2 > const &snake_vertices, glm::vec2 const &head, glm::vec2 const &tail,
+		glm::vec2 const &size, glm::u8vec4 const &color) {
+	size_t index = 0;
+	glm::vec2 prev_vertex = head;
+	for (auto const &span : snake_vertices.spans()) {
+		for (glm::vec2 const &vertex : span) {
+			glm::vec2 cur_vertex = (index + 1 == snake_vertices.size() ? tail : vertex);
+			if (index > 0) {
+				draw_unaligned_rectangle(list, cur_vertex, prev_vertex, size, color);
+				prev_vertex = cur_vertex;
 			}
-			//warp y velocity based on offset from paddle center:
-			float vel = (snake_vertices[0].y - paddle.y) / (paddle_size.y + snake_size.y);
-			snake_velocity.y = glm::mix(snake_velocity.y, vel, 0.75f);
-		}
-	};
-	paddle_vs_head(left_paddle);
-	paddle_vs_head(right_paddle);
-
-	//court walls:
-	if (snake_vertices[0].y > court_size.y - snake_size.y) {
-		snake_vertices[0].y = 2 * (court_size.y - snake_size.y) -
-			snake_vertices[0].y;
-		snake_vertices.push_front(glm::vec2(snake_vertices[0].x,
-					court_size.y - snake_size.y));
-		if (snake_velocity.y > 0.0f) {
-			snake_velocity.y = -snake_velocity.y;
-		}
-	} else if (snake_vertices[0].y < -court_size.y + snake_size.y) {
-		snake_vertices[0].y = 2 * (-court_size.y + snake_size.y) -
-			snake_vertices[0].y;
-		snake_vertices.push_front(glm::vec2(snake_vertices[0].x,
-					-court_size.y + snake_size.y));
-		if (snake_velocity.y < 0.0f) {
-			snake_velocity.y = -snake_velocity.y;
+			index += 1;
 		}
 	}
+}
 
-	if (snake_vertices[0].x > court_size.x - snake_size.x) {
-		damaged(paddle_miss_damage);
-
-		snake_vertices[0].x = 2 * (court_size.x - snake_size.x) -
-			snake_vertices[0].x;
-		snake_vertices.push_front(glm::vec2(court_size.x - snake_size.x,
-					snake_vertices[0].y));
-		if (snake_velocity.x > 0.0f) {
-			snake_velocity.x = -snake_velocity.x;
-		}
-	} else if (snake_vertices[0].x < -court_size.x + snake_size.x) {
-		damaged(paddle_miss_damage);
-
-		snake_vertices[0].x = 2 * (-court_size.x + snake_size.x) -
-			snake_vertices[0].x;
-		snake_vertices.push_front(glm::vec2(-court_size.x + snake_size.x,
-					snake_vertices[0].y));
-		if (snake_velocity.x < 0.0f) {
-			snake_velocity.x = -snake_velocity.x;
-		}
+//just the head and tail segments of the above (the ones that can move between updates):
+template< typename List >
+static void draw_snake_ends(List &list, RingBuffer< glm::vec2 > const &snake_vertices, glm::vec2 const &head, glm::vec2 const &tail,
+		glm::vec2 const &size, glm::u8vec4 const &color) {
+	size_t n = snake_vertices.size();
+	if (n == 2) {
+		draw_unaligned_rectangle(list, tail, head, size, color);
+	} else if (n > 2) {
+		draw_unaligned_rectangle(list, snake_vertices[1], head, size, color);
+		draw_unaligned_rectangle(list, tail, snake_vertices[n-2], size, color);
 	}
+}
 
-	// green fruit
-	if(abs(snake_vertices[0].x - green_fruit.x) < snake_radius + fruit_radius &&
-			abs(snake_vertices[0].y - green_fruit.y) < snake_radius + fruit_radius) {
-		// regenerate green_fruit someplace else
-		green_fruit.x = (mt() / float(mt.max()) * court_size.x - court_size.x) * 0.8;
-		green_fruit.y = (mt() / float(mt.max()) * court_size.y - court_size.y) * 0.8;
-		
-		// increase snake length
-		length_update_buffer += green_fruit_length_increase;
-		snake_length += green_fruit_length_increase;
-	}
+//corners of segments [0, count) of 'polyline' (segment i runs from polyline[i+1] to polyline[i]), made by segment_quads
+// a chunk at a time on 'pool's threads and handed to store(i, corners) -- which is called from any of those threads, so
+// must only write where segment i's quad goes:
+template< typename Store >
+static void build_snake_quads(ThreadPool &pool, glm::vec2 const *polyline, size_t count, glm::vec2 const &size, Store const &store) {
+	size_t const chunk = 1024; //(small enough that its corners are still in cache when they are stored)
+	pool.parallel_for((count + chunk - 1) / chunk, [&](size_t c, size_t) {
+		glm::vec2 corners[4 * chunk];
+		size_t begin = c * chunk;
+		size_t end = std::min(count, begin + chunk);
+		segment_quads(polyline + begin, end - begin, size, corners);
+		for (size_t i = begin; i < end; ++i) {
+			store(i, corners + 4 * (i - begin));
+		}
+	});
+}
 
-    // red fruit
-    if(red_fruit_exists) {
-        if(abs(snake_vertices[0].x - red_fruit.x) < snake_radius + fruit_radius &&
-                abs(snake_vertices[0].y - red_fruit.y) < snake_radius + fruit_radius) {
-            // heal
-            damaged(-red_fruit_heal);
+//draw_snake for long snakes -- the same quads in the same order -- from 'polyline' (the snake's vertices, head first,
+// with the ends at head and tail):
+template< typename List >
+static void draw_snake_parallel(List &list, ThreadPool &pool, std::vector< glm::vec2 > const &polyline,
+		glm::vec2 const &size, glm::u8vec4 const &color) {
+	if (polyline.size() < 2) return;
+	size_t const per = quad_size(list);
+	size_t const at = list.size();
+	list.resize(at + per * (polyline.size() - 1));
+	auto *out = list.data() + at;
+	build_snake_quads(pool, polyline.data(), polyline.size() - 1, size, [&](size_t i, glm::vec2 const *corners) {
+		put_quad(out + per * i, corners, color);
+	});
+}
 
-            red_fruit_exists = false;
-        }
-    } else {
-        // otherwise spawn a red fruit with a chance
-        if(mt() / float(mt.max()) < red_fruit_chance) {
-            red_fruit.x = (mt() / float(mt.max()) * court_size.x - court_size.x) * 0.8;
-            red_fruit.y = (mt() / float(mt.max()) * court_size.y - court_size.y) * 0.8;
-            red_fruit_exists = true;
-        }
-    }
+ThreadPool *PongMode::snake_pool_for(size_t segments) {
+	if (segments < parallel_snake_segments) return nullptr;
+	if (!snake_pool) snake_pool.reset(new ThreadPool());
+	return snake_pool.get();
+}
 
-	// snake head with body
-	// we ignore the second snake segment for balance, so we can skip if there
-	// are less than 4 vertices
-	if(snake_vertices.size() > 3) {
-        bool tick_collided = false;
+void PongMode::update_snake_layer() {
+	RingBuffer< glm::vec2 > const &snake_vertices = sim.snake_vertices[0];
+	uint32_t const head_serial = sim.head_serial[0];
+	//body segments are the ones between vertex 1 and vertex n-2, so have ids [lo, hi):
+	uint32_t const hi = head_serial;
+	uint32_t const lo = (snake_vertices.size() >= 4 ? head_serial - uint32_t(snake_vertices.size() - 1) + 2 : hi);
+	auto vertex = [&](uint32_t serial) -> glm::vec2 const & {
+		return snake_vertices[head_serial - serial];
+	};
 
-		auto it = snake_vertices.begin();
-		glm::vec2 head = *it;
-		it += 2; // skip second segment
+	//segments already in the ring that are still in the body:
+	uint32_t keep_begin = std::max(lo, snake_begin);
+	uint32_t keep_end = std::min(hi, snake_end);
+
+	if (hi - lo > snake_slots) {
+		//out of room, so start over in a bigger ring:
+		snake_slots = std::max(64u, 2u * snake_slots);
+		while (snake_slots < hi - lo) snake_slots *= 2;
+		snake_layer.buffer.reserve(snake_slots * 6 * sizeof(Vertex));
+		snake_ends.assign(2 * snake_slots, glm::vec2(0.0f));
+		keep_end = keep_begin;
+	}
+	uint32_t const mask = snake_slots - 1;
 
-		glm::vec2 cur_vertex = *it++;
-		glm::vec2 prev_vertex;
-		while(it != snake_vertices.end()) {
-				prev_vertex = cur_vertex;
-				cur_vertex = *it++;
-
-			// collision if distance from point to line is less than diameter
-			float d = abs((cur_vertex.y - prev_vertex.y) * head.x -
-					(cur_vertex.x - prev_vertex.x) * head.y +
-					cur_vertex.x * prev_vertex.y -
-					cur_vertex.y * prev_vertex.x) /
-				veclength(cur_vertex - prev_vertex);
-
-			if(d < 2 * snake_radius) {
-                if(!last_collided) {
-                    damaged(collision_damage);
-                }
-                tick_collided = true;
-				break;
+	auto current = [&](uint32_t id) {
+		uint32_t slot = id & mask;
+		return snake_ends[2 * slot] == vertex(id - 1) && snake_ends[2 * slot + 1] == vertex(id);
+	};
+	//the newest kept segment is the one a bounce can merge away (see SnakeSim::push_head):
+	if (keep_begin < keep_end && !current(keep_end - 1)) keep_end -= 1;
+	//...anything else (e.g., a new game) means starting over:
+	if (keep_begin < keep_end && !(current(keep_begin) && current(keep_end - 1))) keep_end = keep_begin;
+	if (keep_begin >= keep_end) keep_begin = keep_end = lo;
+
+	//build and upload segments [begin, end), a contiguous run of slots at a time:
+	std::vector< Vertex > &vertices = snake_layer.vertices;
+	auto write = [&](uint32_t begin, uint32_t end) {
+		while (begin < end) {
+			uint32_t run = std::min(end - begin, snake_slots - (begin & mask));
+			vertices.clear();
+			if (ThreadPool *pool = snake_pool_for(run)) {
+				//long runs (e.g., the whole body when the ring grows) are built in parallel from a copy of the run's vertices, head first --
+				// so polyline segment j is segment id begin + run - 1 - j:
+				uint32_t const first = head_serial - (begin + run - 1);
+				snake_polyline.clear();
+				for (uint32_t i = first; i <= first + run; ++i) {
+					snake_polyline.emplace_back(snake_vertices[i]);
+				}
+				vertices.resize(6 * size_t(run));
+				build_snake_quads(*pool, snake_polyline.data(), run, SnakeSim::snake_size, [&](size_t j, glm::vec2 const *corners) {
+					uint32_t offset = run - 1 - uint32_t(j);
+					uint32_t slot = (begin + offset) & mask;
+					snake_ends[2 * slot] = snake_polyline[j + 1];
+					snake_ends[2 * slot + 1] = snake_polyline[j];
+					put_quad(&vertices[6 * offset], corners, snake_color);
+				});
+			} else {
+				for (uint32_t id = begin; id < begin + run; ++id) {
+					uint32_t slot = id & mask;
+					snake_ends[2 * slot] = vertex(id - 1);
+					snake_ends[2 * slot + 1] = vertex(id);
+					draw_unaligned_rectangle(vertices, vertex(id - 1), vertex(id), SnakeSim::snake_size, snake_color);
+				}
 			}
+			snake_layer.buffer.update((begin & mask) * 6 * sizeof(Vertex), vertices.data(), vertices.size() * sizeof(Vertex));
+			begin += run;
 		}
+	};
+	write(lo, keep_begin);
+	write(keep_end, hi);
 
-        last_collided = tick_collided;
-	} else {
-        last_collided = false;
-    }
+	snake_begin = lo;
+	snake_end = hi;
 }
 
 void PongMode::draw(glm::uvec2 const &drawable_size) {
 
+	//game constants and state used for drawing:
+	glm::vec2 const court_size = sim.config.court_size;
+	glm::vec2 const paddle_size = SnakeSim::paddle_size;
+	glm::vec2 const snake_size = SnakeSim::snake_size;
+	glm::vec2 const fruit_size = SnakeSim::fruit_size;
+
+	glm::vec2 const &right_paddle = sim.right_paddle[0]; //(follows the mouse directly, so isn't blended)
+	RingBuffer< glm::vec2 > const &snake_vertices = sim.snake_vertices[0];
+
+	//blend moving things from the previous update to the latest one:
+	glm::vec2 const left_paddle = glm::mix(prev_left_paddle, sim.left_paddle[0], interpolation);
+	//the head and tail vertices move smoothly unless a vertex was added or removed at that end:
+	uint32_t const head_serial = sim.head_serial[0];
+	uint32_t const tail_serial = head_serial - uint32_t(snake_vertices.size() - 1);
+	glm::vec2 const neck = snake_vertices[snake_vertices.size() > 1 ? 1 : 0];
+	glm::vec2 const head = (head_serial == prev_head_serial && neck == prev_neck
+		? glm::mix(prev_head, snake_vertices.front(), interpolation)
+		: snake_vertices.front());
+	glm::vec2 const tail = (tail_serial == prev_tail_serial
+		? glm::mix(prev_tail, snake_vertices.back(), interpolation)
+		: snake_vertices.back());
+
 	//other useful drawing constants:
 	const float wall_radius = 0.05f;
 	const float shadow_offset = 0.07f;
 	const float padding = 0.14f; //padding between outside of walls and edge of window
 
 	//---- compute vertices to draw ----
+	//(everything is stacked as it always has been: wall shadows, then paddle shadows and the snake,
+	// then walls, then paddles and fruit, then hearts)
 
-	//vertices will be accumulated into this list and then uploaded+drawn at the end of this function:
-	std::vector< Vertex > vertices;
+	glm::vec2 s = glm::vec2(0.0f,-shadow_offset);
 
-	// List of circles to be drawn
-	std::vector<std::vector<Vertex>> circles;
+	//(upload counts are per frame)
+	for (Layer *layer : {&static_layer, &hud_layer, &dynamic_layer, &snake_layer}) {
+		layer->buffer.counts = StreamBuffer::Counts();
+	}
+	for (StreamBuffer *buffer : {&rects_buffer, &snake_polyline_buffer, &quads_buffer, &quad_indices}) {
+		buffer->counts = StreamBuffer::Counts();
+	}
+	gl_state.counts = GLState::Counts();
+
+	//walls and their shadows never change, so they are only built (and the static layer uploaded) once:
+	if (static_layer.vertices.empty()) {
+		draw_walls(static_layer.vertices, court_size, wall_radius, s, shadow_color);
+		static_walls = static_layer.vertices.size();
+		draw_walls(static_layer.vertices, court_size, wall_radius, glm::vec2(0.0f), fg_color);
+		static_layer.buffer.upload(static_layer.vertices);
+
+		draw_walls(wall_shadow_rects, court_size, wall_radius, s, shadow_color);
+		draw_walls(wall_rects, court_size, wall_radius, glm::vec2(0.0f), fg_color);
+		draw_walls(wall_shadow_quads, court_size, wall_radius, s, shadow_color);
+		draw_walls(wall_quads, court_size, wall_radius, glm::vec2(0.0f), fg_color);
+	}
 
-	// inline helper function for rectangle drawing:
-	auto draw_rectangle = [&vertices](glm::vec2 const &center,
-			glm::vec2 const &size, glm::u8vec4 const &color) {
-		// draw rectangle as two CCW-oriented triangles:
-		vertices.emplace_back(glm::vec3(center.x-size.x, center.y-size.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+size.x, center.y-size.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+size.x, center.y+size.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+	//hearts at top of screen only change with health:
+	if (sim.health[0] != hud_health) hud_dirty = true;
+	if (hud_dirty) {
+		hud_health = sim.health[0];
+		hud_layer.vertices.clear();
+		draw_hearts(hud_layer.vertices, hud_health, court_size, wall_radius, life_color);
+		hud_layer.buffer.upload(hud_layer.vertices);
+
+		heart_rects.clear();
+		draw_hearts(heart_rects, hud_health, court_size, wall_radius, life_color);
+		heart_quads.clear();
+		draw_hearts(heart_quads, hud_health, court_size, wall_radius, life_color);
+		hud_dirty = false;
+	}
 
-		vertices.emplace_back(glm::vec3(center.x-size.x, center.y-size.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x+size.x, center.y+size.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
-		vertices.emplace_back(glm::vec3(center.x-size.x, center.y+size.y, 0.0f), color, glm::vec2(0.5f, 0.5f));
+	//everything else can move, so is rebuilt every frame:
+	//(the triangle paths keep the walls and hearts in their own layers; the rect and indexed paths copy them in,
+	// so that the whole scene is one list)
+	std::vector< Vertex > &vertices = dynamic_layer.vertices;
+	vertices.clear();
+	size_t const vertices_capacity = vertices.capacity();
+	rects.clear();
+	size_t const rects_capacity = rects.capacity();
+	quads.clear();
+	size_t const quads_capacity = quads.capacity();
+
+	//the snake's vertices as one array, head first, with the ends blended:
+	auto build_snake_polyline = [&,this]() {
+		snake_polyline.clear();
+		for (auto const &span : snake_vertices.spans()) {
+			snake_polyline.insert(snake_polyline.end(), span.begin(), span.end());
+		}
+		snake_polyline.front() = head;
+		snake_polyline.back() = tail;
 	};
 
-	// inline helper function for rectangles not aligned with axis
-	// requires vertex1 to be on top-left or bottom-right of vertex 2
-	auto draw_unaligned_rectangle = [&vertices](glm::vec2 const &vertex1,
-			glm::vec2 const &vertex2, glm::vec2 const &size,
-			glm::u8vec4 const &color) {
-		float length = distance(vertex1, vertex2);
-		float x_ratio = abs(vertex1.x - vertex2.x) / length;
-		float y_ratio = abs(vertex1.y - vertex2.y) / length;
-
-		if(vertex1.y == vertex2.y ||
-			(vertex1.x - vertex2.x) / (vertex1.y - vertex2.y) > 0) {
-			const glm::vec2 &botleft = vertex1.x - vertex2.x < 0 ? vertex1 :
-				vertex2;
-			const glm::vec2 &topright = vertex1.x - vertex2.x < 0 ? vertex2 :
-				vertex1;
-
-			vertices.emplace_back(glm::vec3(botleft.x - size.x * x_ratio + size.y * y_ratio, botleft.y - size.x * y_ratio - size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-			vertices.emplace_back(glm::vec3(topright.x + size.x * x_ratio + size.y * y_ratio, topright.y + size.x * y_ratio - size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-			vertices.emplace_back(glm::vec3(topright.x + size.x * x_ratio - size.y * y_ratio, topright.y + size.x * y_ratio + size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-
-			vertices.emplace_back(glm::vec3(botleft.x - size.x * x_ratio + size.y * y_ratio, botleft.y - size.x * y_ratio - size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-			vertices.emplace_back(glm::vec3(topright.x + size.x * x_ratio - size.y * y_ratio, topright.y + size.x * y_ratio + size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-			vertices.emplace_back(glm::vec3(botleft.x - size.x * x_ratio - size.y * y_ratio, botleft.y - size.x * y_ratio + size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-		} else {
-			const glm::vec2 &topleft = vertex1.x - vertex2.x < 0 ? vertex1 :
-				vertex2;
-			const glm::vec2 &botright = vertex1.x - vertex2.x < 0 ? vertex2 :
-				vertex1;
-
-			vertices.emplace_back(glm::vec3(topleft.x - size.x * x_ratio + size.y * y_ratio, topleft.y + size.x * y_ratio + size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-			vertices.emplace_back(glm::vec3(botright.x + size.x * x_ratio + size.y * y_ratio, botright.y - size.x * y_ratio + size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-			vertices.emplace_back(glm::vec3(botright.x + size.x * x_ratio - size.y * y_ratio, botright.y - size.x * y_ratio - size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-
-			vertices.emplace_back(glm::vec3(topleft.x - size.x * x_ratio + size.y * y_ratio, topleft.y + size.x * y_ratio + size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-			vertices.emplace_back(glm::vec3(botright.x + size.x * x_ratio - size.y * y_ratio, botright.y - size.x * y_ratio - size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-			vertices.emplace_back(glm::vec3(topleft.x - size.x * x_ratio - size.y * y_ratio, topleft.y + size.x * y_ratio - size.y * x_ratio, 0.0f), color, glm::vec2(0.5f, 0.5f)); 
-		}
+	//(each of these builds its part of the scene in either list)
+	auto draw_shadows = [&,this](auto &list) {
+		//shadows (for the paddles -- the walls' are built with the walls); each is just a second copy, offset:
+		draw_rectangle(list, left_paddle+s, paddle_size, shadow_color);
+		draw_rectangle(list, right_paddle+s, paddle_size, shadow_color);
+		//TODO shadow for snake?
+		//draw_rectangle(list, ball+s, snake_size, shadow_color);
 	};
+	auto draw_solids = [&,this](auto &list) {
+		//paddles:
+		draw_rectangle(list, left_paddle, paddle_size, paddle_color);
+		draw_rectangle(list, right_paddle, paddle_size, paddle_color);
 
-	//shadows for everything (except the trail):
+		// green fruit
+		draw_rectangle(list, sim.green_fruit[0], fruit_size, green_fruit_color);
 
-	glm::vec2 s = glm::vec2(0.0f,-shadow_offset);
+		// red fruit
+		if(sim.red_fruit_exists[0]) {
+			draw_rectangle(list, sim.red_fruit[0], fruit_size, red_fruit_color);
+		}
+	};
 
-	draw_rectangle(glm::vec2(-court_size.x-wall_radius, 0.0f)+s, glm::vec2(wall_radius, court_size.y + 2.0f * wall_radius), shadow_color);
-	draw_rectangle(glm::vec2( court_size.x+wall_radius, 0.0f)+s, glm::vec2(wall_radius, court_size.y + 2.0f * wall_radius), shadow_color);
-	draw_rectangle(glm::vec2( 0.0f,-court_size.y-wall_radius)+s, glm::vec2(court_size.x, wall_radius), shadow_color);
-	draw_rectangle(glm::vec2( 0.0f, court_size.y+wall_radius)+s, glm::vec2(court_size.x, wall_radius), shadow_color);
-	draw_rectangle(left_paddle+s, paddle_size, shadow_color);
-	draw_rectangle(right_paddle+s, paddle_size, shadow_color);
-	//TODO shadow for snake?
-	//draw_rectangle(ball+s, snake_size, shadow_color);
-
-	//solid objects:
-
-	// snake body
-	auto it = snake_vertices.begin();
-	glm::vec2 prev_vertex = *it++;
-	while(it != snake_vertices.end()) {
-		glm::vec2 cur_vertex = *it++;
-		draw_unaligned_rectangle(cur_vertex, prev_vertex, snake_size,
-                snake_color);
-		prev_vertex = cur_vertex;
+	if (draw_path == DrawRects) {
+		rects.insert(rects.end(), wall_shadow_rects.begin(), wall_shadow_rects.end());
+		draw_shadows(rects);
+		// snake body
+		draw_snake(rects, snake_vertices, head, tail, snake_size, snake_color);
+		rects.insert(rects.end(), wall_rects.begin(), wall_rects.end());
+		draw_solids(rects);
+		rects.insert(rects.end(), heart_rects.begin(), heart_rects.end());
+	} else if (draw_path == DrawIndexed) {
+		quads.insert(quads.end(), wall_shadow_quads.begin(), wall_shadow_quads.end());
+		draw_shadows(quads);
+		// snake body
+		if (ThreadPool *pool = snake_pool_for(snake_vertices.size() - 1)) {
+			build_snake_polyline();
+			draw_snake_parallel(quads, *pool, snake_polyline, snake_size, snake_color);
+		} else {
+			draw_snake(quads, snake_vertices, head, tail, snake_size, snake_color);
+		}
+		quads.insert(quads.end(), wall_quads.begin(), wall_quads.end());
+		draw_solids(quads);
+		quads.insert(quads.end(), heart_quads.begin(), heart_quads.end());
+	} else {
+		draw_shadows(vertices);
+		// snake body
+		if (draw_path == DrawSnakeVertices) {
+			//(just the vertices -- snake_program makes them into quads)
+			build_snake_polyline();
+		} else {
+			//(only the ends are rebuilt every frame -- the rest is kept in snake_layer)
+			draw_snake_ends(vertices, snake_vertices, head, tail, snake_size, snake_color);
+			update_snake_layer();
+		}
+		dynamic_solids = vertices.size();
+		draw_solids(vertices);
 	}
 
-	//walls:
-	draw_rectangle(glm::vec2(-court_size.x-wall_radius, 0.0f), glm::vec2(wall_radius, court_size.y + 2.0f * wall_radius), fg_color);
-	draw_rectangle(glm::vec2( court_size.x+wall_radius, 0.0f), glm::vec2(wall_radius, court_size.y + 2.0f * wall_radius), fg_color);
-	draw_rectangle(glm::vec2( 0.0f,-court_size.y-wall_radius), glm::vec2(court_size.x, wall_radius), fg_color);
-	draw_rectangle(glm::vec2( 0.0f, court_size.y+wall_radius), glm::vec2(court_size.x, wall_radius), fg_color);
-
-	//paddles:
-	draw_rectangle(left_paddle, paddle_size, paddle_color);
-	draw_rectangle(right_paddle, paddle_size, paddle_color);
-
-	// green fruit
-	draw_rectangle(green_fruit, fruit_size, green_fruit_color);
-
-    // red fruit
-    if(red_fruit_exists) {
-        draw_rectangle(red_fruit, fruit_size, red_fruit_color);
-    }
-
-    // hearts at top of screen
-    for(int i = 0; i < health; i++) {
-        glm::vec2 pos = glm::vec2(-court_size.x + 0.5f + 1.0f * i,
-                court_size.y + 0.3f + 2.0f * wall_radius);
-        glm::vec2 offset1 = glm::vec2(-0.2f, 0.2f);
-        glm::vec2 offset2 = glm::vec2(0.2f, 0.2f);
-        draw_unaligned_rectangle(pos + offset1, pos, glm::vec2(0.2f, 0.2f), life_color);
-        draw_unaligned_rectangle(pos + offset2, pos, glm::vec2(0.2f, 0.2f), life_color);
-    }
-
 	//------ compute court-to-window transform ------
 
 	//compute area that should be visible:
@@ -566,43 +751,130 @@ void PongMode::draw(glm::uvec2 const &drawable_size) {
 	glClearColor(bg_color.r / 255.0f, bg_color.g / 255.0f, bg_color.b / 255.0f, bg_color.a / 255.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	//(state is set through gl_state, and left set after drawing -- so, from the second frame on, most of these calls are
+	// skipped, as nothing has changed them)
+
 	//use alpha blending:
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	gl_state.enable(GL_BLEND);
+	gl_state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//don't use the depth test:
-	glDisable(GL_DEPTH_TEST);
-
-	//upload vertices to vertex_buffer:
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer); //set vertex_buffer as current
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STREAM_DRAW); //upload vertices array
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	//set color_texture_program as current program:
-	glUseProgram(color_texture_program.program);
-
-	//upload OBJECT_TO_CLIP to the proper uniform location:
-	glUniformMatrix4fv(color_texture_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
-
-	//use the mapping vertex_buffer_for_color_texture_program to fetch vertex data:
-	glBindVertexArray(vertex_buffer_for_color_texture_program);
+	gl_state.disable(GL_DEPTH_TEST);
 
-	//bind the solid white texture to location zero so things will be drawn just with their colors:
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, white_tex);
+	if (draw_path == DrawRects) {
+		//upload the rectangles (reusing the buffer's storage if they fit):
+		rects_buffer.upload(rects);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	//run the OpenGL pipeline:
-	glDrawArrays(GL_TRIANGLES, 0, GLsizei(vertices.size()));
+		gl_state.use_program(rect_instance_program.program);
+		glUniformMatrix4fv(rect_instance_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
+
+		//the whole scene in one call -- four corners (as a triangle strip) for each rectangle, in order:
+		gl_state.bind_vertex_array(rects_vertex_array);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(rects.size()));
+	} else if (draw_path == DrawIndexed) {
+		uint32_t count = uint32_t(quads.size() / 4);
+		if (count > quad_indices_quads) {
+			//(room for twice as many quads, so this happens only now and then as the snake grows)
+			quad_indices_quads = std::max(count, 2 * quad_indices_quads);
+			std::vector< uint32_t > indices;
+			indices.reserve(6 * quad_indices_quads);
+			for (uint32_t q = 0; q < quad_indices_quads; ++q) {
+				for (uint32_t i : {0, 1, 2, 0, 2, 3}) {
+					indices.emplace_back(4 * q + i);
+				}
+			}
+			//(the element buffer binding is part of the vertex array object's state, so bind that first)
+			gl_state.bind_vertex_array(quads_vertex_array);
+			quad_indices.upload(indices);
+		}
 
-	//unbind the solid white texture:
-	glBindTexture(GL_TEXTURE_2D, 0);
+		//upload the quads (reusing the buffer's storage if they fit):
+		quads_buffer.upload(quads);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	//reset vertex array to none:
-	glBindVertexArray(0);
+		gl_state.use_program(color_program.program);
+		glUniformMatrix4fv(color_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
 
-	//reset current program to none:
-	glUseProgram(0);
+		//the whole scene in one call -- six indices (two triangles) for each quad, in order:
+		gl_state.bind_vertex_array(quads_vertex_array);
+		glDrawElements(GL_TRIANGLES, GLsizei(6 * count), GL_UNSIGNED_INT, (GLbyte *)0);
+	} else {
+		//upload the dynamic layer's vertices (reusing its buffer's storage if they fit):
+		dynamic_layer.buffer.upload(vertices);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+		//set color_texture_program as current program:
+		gl_state.use_program(color_texture_program.program);
+
+		//upload OBJECT_TO_CLIP to the proper uniform location:
+		glUniformMatrix4fv(color_texture_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
+
+		//bind the solid white texture to location zero so things will be drawn just with their colors:
+		gl_state.bind_texture(0, GL_TEXTURE_2D, white_tex);
+
+		//run the OpenGL pipeline on each range, back to front (using each layer's vertex array object to fetch its vertex data):
+		auto draw_range = [](Layer const &layer, size_t begin, size_t end) {
+			if (begin == end) return;
+			gl_state.bind_vertex_array(layer.vertex_array);
+			glDrawArrays(GL_TRIANGLES, GLint(begin), GLsizei(end - begin));
+		};
+		draw_range(static_layer, 0, static_walls);
+		draw_range(dynamic_layer, 0, dynamic_solids);
+		if (draw_path == DrawSnakeVertices) {
+			//upload the snake's vertices and have snake_program make a quad of every segment:
+			snake_polyline_buffer.upload(snake_polyline);
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+			gl_state.use_program(snake_program.program);
+			glUniformMatrix4fv(snake_program.OBJECT_TO_CLIP_mat4, 1, GL_FALSE, glm::value_ptr(court_to_clip));
+			glUniform2f(snake_program.SIZE_vec2, snake_size.x, snake_size.y);
+			glUniform4f(snake_program.COLOR_vec4, snake_color.r / 255.0f, snake_color.g / 255.0f, snake_color.b / 255.0f, snake_color.a / 255.0f);
+			//(unit zero's GL_TEXTURE_2D binding stays white_tex -- each program only samples one of them)
+			gl_state.bind_texture(0, GL_TEXTURE_BUFFER, snake_polyline_tex);
+
+			gl_state.bind_vertex_array(empty_vertex_array);
+			glDrawArrays(GL_TRIANGLES, 0, GLsizei(6 * (snake_polyline.size() - 1)));
+
+			//back to color_texture_program for the rest:
+			gl_state.use_program(color_texture_program.program);
+		} else {
+			//(the ring's segments are in one run of slots, or two if they wrap around the end)
+			uint32_t first = snake_begin & (snake_slots - 1);
+			uint32_t count = snake_end - snake_begin;
+			uint32_t run = std::min(count, snake_slots - first);
+			draw_range(snake_layer, 6 * first, 6 * (first + run));
+			draw_range(snake_layer, 0, 6 * (count - run));
+		}
+		draw_range(static_layer, static_walls, static_layer.vertices.size());
+		draw_range(dynamic_layer, dynamic_solids, dynamic_layer.vertices.size());
+		draw_range(hud_layer, 0, hud_layer.vertices.size());
+	}
 
 	GL_ERRORS(); //PARANOIA: print errors just in case we did something wrong.
 
+	{ //(counted every frame, but only printed -- and started over -- if print_draw_stats is set)
+		draw_stats.frames += 1;
+		draw_stats.vertices += vertices.size();
+		draw_stats.rects += rects.size();
+		draw_stats.quads += quads.size() / 4;
+		for (StreamBuffer *buffer : {&static_layer.buffer, &hud_layer.buffer, &dynamic_layer.buffer, &snake_layer.buffer, &rects_buffer, &snake_polyline_buffer, &quads_buffer, &quad_indices}) {
+			draw_stats.upload_bytes += buffer->counts.bytes;
+			draw_stats.buffer_reallocations += buffer->counts.reallocations;
+		}
+		draw_stats.vector_reallocations += (vertices.capacity() != vertices_capacity) + (rects.capacity() != rects_capacity)
+			+ (quads.capacity() != quads_capacity);
+		draw_stats.gl_calls += gl_state.counts.issued;
+		draw_stats.gl_calls_elided += gl_state.counts.elided;
+		if (print_draw_stats && draw_stats.frames == 60) {
+			std::cout << "draw: " << draw_stats.vertices / draw_stats.frames << " vertices, "
+				<< draw_stats.rects / draw_stats.frames << " rects, "
+				<< draw_stats.quads / draw_stats.frames << " quads, "
+				<< draw_stats.upload_bytes / draw_stats.frames << " bytes uploaded per frame; "
+				<< draw_stats.buffer_reallocations << " buffer and " << draw_stats.vector_reallocations
+				<< " vertex/rect/quad list reallocations in " << draw_stats.frames << " frames; "
+				<< draw_stats.gl_calls / draw_stats.frames << " state-setting GL calls made and "
+				<< draw_stats.gl_calls_elided / draw_stats.frames << " skipped per frame" << std::endl;
+			draw_stats = DrawStats();
+		}
+	}
 }
@@ -1,19 +1,31 @@
 #include "ColorTextureProgram.hpp"
+#include "ColorProgram.hpp"
+#include "RectInstanceProgram.hpp"
+#include "SnakeProgram.hpp"
+#include "StreamBuffer.hpp"
 
 #include "Mode.hpp"
 #include "GL.hpp"
+#include "SnakeSim.hpp"
+#include "Replay.hpp"
+#include "PaddleBot.hpp"
+#include "Rollback.hpp"
+#include "Netplay.hpp"
+#include "ThreadPool.hpp"
 
 #include <glm/glm.hpp>
 
 #include <vector>
-#include <deque>
+#include <string>
+#include <memory>
 
 /*
  * PongMode is a game mode that implements a single-player game of Pong.
  */
 
 struct PongMode : Mode {
-	PongMode();
+	//'seed' picks the fruit sequence (see SnakeSim::add_games):
+	PongMode(uint32_t seed = 0);
 	virtual ~PongMode();
 
 	//functions called by main loop:
@@ -21,57 +33,47 @@ struct PongMode : Mode {
 	virtual void update(float elapsed) override;
 	virtual void draw(glm::uvec2 const &drawable_size) override;
 
-	void setup();
-	void damaged(int damage);
-
-	// game constants
-	static constexpr glm::vec2 court_size = glm::vec2(9.6f, 6.0f);
-	static constexpr glm::vec2 paddle_size = glm::vec2(0.2f, 1.0f);
-
-	static constexpr float snake_radius = 0.2f;
-	static constexpr glm::vec2 snake_size = glm::vec2(snake_radius,
-			snake_radius);
-
-	static constexpr float fruit_radius = 0.3f;
-	static constexpr glm::vec2 fruit_size = glm::vec2(fruit_radius,
-			fruit_radius);
-	static constexpr float green_fruit_length_increase = 0.5f;
-
-	static constexpr int initial_health = 5;
-	static constexpr int collision_damage = 2;
-	static constexpr int paddle_miss_damage = 1;
-
-    static constexpr float red_fruit_chance = 0.101;
-	static constexpr int red_fruit_heal = 1;
-
-    static constexpr float initial_snake_length = 10.5f;
-
-	//----- game state -----
-    bool running;
-
-	glm::vec2 left_paddle;
-	glm::vec2 right_paddle;
-
-	glm::vec2 snake_velocity = glm::vec2(-1.0f, 0.0f);
-
-	float snake_length = initial_snake_length;
-	std::deque<glm::vec2> snake_vertices;
-
-	glm::vec2 green_fruit;
-    bool red_fruit_exists;
-	glm::vec2 red_fruit;
-
-	float length_update_buffer = 0.0f;
-
-	// flag to prevent multiple collisions along the same segment
-	bool last_collided;
-
-	int health;
+	//game logic lives in the (GL-free) simulation; this mode plays game zero:
+	SnakeSim sim;
+
+	//every input applied to the game this session, so it can be re-run exactly
+	// (the whole session, not just one game -- each game continues the last one's fruit sequence;
+	//  events are only kept when replay_filename is set):
+	Replay replay;
+	//if not empty, replay is saved here whenever a game ends (and when the mode is destroyed):
+	std::string replay_filename;
+	void save_replay();
+	//applies an input to the game (through replay, if it is being saved):
+	void input(Replay::Type type, float value);
+
+	//if set, a bot plays both paddles (and starts a new game whenever one ends), ignoring the mouse and keyboard:
+	bool autoplay = false;
+	PaddleBot bot;
+
+	//snapshots of the game after each of the last few updates (for rewinding or re-simulating them):
+	Rollback history;
+
+	//if set, this is one side of a two-player game over the network, and only that side's paddle is played here
+	// (updates wait until both players' inputs for them are in -- see Netplay):
+	std::unique_ptr< Netplay > netplay;
+	bool netplay_restart = false; //restart asked for, but not yet sent
+	float netplay_paddle = 0.0f; //right paddle position from the mouse (when playing the right side)
+	uint32_t netplay_desyncs = 0; //(desyncs reported so far)
 
     // keyboard flags
     bool w_pressed = false;
     bool s_pressed = false;
 
+	//game state as of the update before the latest one, so draw can interpolate (see Mode::interpolation):
+	void remember_state();
+	glm::vec2 prev_left_paddle = glm::vec2(0.0f);
+	glm::vec2 prev_head = glm::vec2(0.0f);
+	glm::vec2 prev_tail = glm::vec2(0.0f);
+	glm::vec2 prev_neck = glm::vec2(0.0f); //vertex 1 (a bounce can merge away a vertex and leave head_serial as it was)
+	//(serials of the head and tail vertices -- the snake can only be blended when these are unchanged)
+	uint32_t prev_head_serial = 0;
+	uint32_t prev_tail_serial = 0;
+
 	//some nice colors from the course web page:
 	#define HEX_TO_U8VEC4( HX ) (glm::u8vec4( (HX >> 24) & 0xff, (HX >> 16) & 0xff, (HX >> 8) & 0xff, (HX) & 0xff ))
 	const glm::u8vec4 bg_color = HEX_TO_U8VEC4(0xb4bfb0ff);
@@ -104,6 +106,7 @@ struct PongMode : Mode {
 
 	//draw functions will work on vectors of vertices, defined as follows:
 	struct Vertex {
+		Vertex() = default; //(so vectors can be resized, then filled in place)
 		Vertex(glm::vec3 const &Position_, glm::u8vec4 const &Color_, glm::vec2 const &TexCoord_) :
 			Position(Position_), Color(Color_), TexCoord(TexCoord_) { }
 		glm::vec3 Position;
@@ -115,15 +118,113 @@ struct PongMode : Mode {
 	//Shader program that draws transformed, vertices tinted with vertex colors:
 	ColorTextureProgram color_texture_program;
 
-	//Buffer used to hold vertex data during drawing:
-	GLuint vertex_buffer = 0;
-
-	//Vertex Array Object that maps buffer locations to color_texture_program attribute locations:
-	GLuint vertex_buffer_for_color_texture_program = 0;
+	//geometry is kept in layers by how often it changes; each layer has its own vertices (kept between frames,
+	// so their storage is reused), buffer, and Vertex Array Object that maps it to color_texture_program attributes:
+	struct Layer {
+		Layer(GLenum usage) : buffer(GL_ARRAY_BUFFER, usage) { }
+		std::vector< Vertex > vertices;
+		StreamBuffer buffer;
+		GLuint vertex_array = 0;
+	};
+	//walls and their shadows (never change, so built and uploaded once):
+	Layer static_layer{GL_STATIC_DRAW};
+	size_t static_walls = 0; //(first vertex of the walls -- their shadows come before)
+	//hearts (rebuilt only when health changes):
+	Layer hud_layer{GL_DYNAMIC_DRAW};
+	bool hud_dirty = true;
+	int hud_health = 0; //(health the hearts show)
+	//snake, paddles, and fruit (rebuilt every frame):
+	Layer dynamic_layer{GL_STREAM_DRAW};
+	size_t dynamic_solids = 0; //(first vertex of the solid objects -- shadows and the snake's ends come before)
+	//the snake's body -- every segment but the (moving) head and tail segments -- is kept between frames as a ring of
+	// quads, segment 'id' (the serial of its vertex nearer the head) in slot id % snake_slots, so only segments that
+	// are new (or were changed by a bounce) get built and uploaded:
+	Layer snake_layer{GL_DYNAMIC_DRAW};
+	uint32_t snake_slots = 0; //(a power of two)
+	uint32_t snake_begin = 0, snake_end = 0; //ids of the segments in the ring are [snake_begin, snake_end)
+	std::vector< glm::vec2 > snake_ends; //the two vertices each slot's quad was built from (to tell if it is still current)
+	void update_snake_layer();
+
+	//...or, if draw_path is DrawRects, everything is drawn as rectangle instances for rect_instance_program:
+	struct Rect {
+		glm::vec2 center;
+		glm::vec2 radius; //half the width and height
+		float angle; //counterclockwise rotation (radians)
+		glm::u8vec4 color;
+	};
+	static_assert(sizeof(Rect) == 4*2 + 4*2 + 4 + 1*4, "PongMode::Rect should be packed");
+
+	enum DrawPath : uint8_t {
+		DrawTriangles, //Vertex triangles in layers, for color_texture_program
+		DrawRects, //Rect instances, for rect_instance_program
+		DrawSnakeVertices, //as DrawTriangles, but the snake's body is drawn by snake_program from its vertices
+		DrawIndexed, //QuadVertex quads, through quad_indices, for color_program
+	} draw_path = DrawTriangles;
+
+	RectInstanceProgram rect_instance_program;
+
+	//rectangles, in the order they are drawn -- rebuilt every frame, but walls and hearts are copied from the lists
+	// below rather than built again -- all in one buffer, drawn with one instanced draw call:
+	std::vector< Rect > rects;
+	StreamBuffer rects_buffer{GL_ARRAY_BUFFER, GL_STREAM_DRAW};
+	GLuint rects_vertex_array = 0; //(maps rects_buffer to rect_instance_program attributes, one Rect per instance)
+	std::vector< Rect > wall_shadow_rects, wall_rects; //(built once)
+	std::vector< Rect > heart_rects; //(rebuilt when hud_dirty, like hud_layer)
+
+	//...or, if draw_path is DrawSnakeVertices, the snake's vertices go to the GPU as they are (8 bytes each, rather than
+	// 144 bytes of quad per segment) and snake_program builds the quads from them:
+	SnakeProgram snake_program;
+	std::vector< glm::vec2 > snake_polyline; //(head first, ends blended -- rebuilt every frame; long snakes' quads are built from it too)
+	StreamBuffer snake_polyline_buffer{GL_TEXTURE_BUFFER, GL_STREAM_DRAW};
+	GLuint snake_polyline_tex = 0; //(buffer texture reading snake_polyline_buffer)
+	GLuint empty_vertex_array = 0; //(snake_program takes no attributes, but drawing still needs a vertex array object bound)
+
+	//...or, if draw_path is DrawIndexed, as quads of just four of these (half the size of a Vertex -- there's no z,
+	// and no TexCoord, as nothing is textured), drawn as triangles 0 1 2 and 0 2 3 of each quad through quad_indices:
+	struct QuadVertex {
+		QuadVertex() = default;
+		QuadVertex(glm::vec2 const &Position_, glm::u8vec4 const &Color_) : Position(Position_), Color(Color_) { }
+		glm::vec2 Position;
+		glm::u8vec4 Color;
+	};
+	static_assert(sizeof(QuadVertex) == 4*2 + 1*4, "PongMode::QuadVertex should be packed");
+
+	ColorProgram color_program;
+
+	//quads, in the order they are drawn -- rebuilt every frame, with walls and hearts copied in as for rects:
+	std::vector< QuadVertex > quads;
+	StreamBuffer quads_buffer{GL_ARRAY_BUFFER, GL_STREAM_DRAW};
+	std::vector< QuadVertex > wall_shadow_quads, wall_quads, heart_quads;
+	//indices of every quad's two triangles, shared by all the quads ever drawn (rebuilt only when more quads need them):
+	StreamBuffer quad_indices{GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW};
+	uint32_t quad_indices_quads = 0; //(quads quad_indices covers)
+	GLuint quads_vertex_array = 0; //(maps quads_buffer to color_program attributes, with quad_indices as its element buffer)
+
+	//the quads of snakes with at least this many segments (for DrawIndexed, and when snake_layer is rebuilt) are made by
+	// segment_quads' SIMD kernel, in chunks spread over snake_pool -- the same bytes as making them one at a time:
+	size_t parallel_snake_segments = 2048;
+	std::unique_ptr< ThreadPool > snake_pool; //(started the first time a snake is that long)
+	//snake_pool if this many segments should be built in parallel, otherwise null (every path decides here):
+	ThreadPool *snake_pool_for(size_t segments);
 
 	//Solid white texture:
 	GLuint white_tex = 0;
 
+	//what draw has uploaded (and how often storage had to grow); if print_draw_stats is set, this is printed
+	// (and started over) about once a second:
+	bool print_draw_stats = false;
+	struct DrawStats {
+		uint32_t frames = 0;
+		uint64_t vertices = 0;
+		uint64_t rects = 0;
+		uint64_t quads = 0;
+		uint64_t upload_bytes = 0;
+		uint32_t buffer_reallocations = 0;
+		uint32_t vector_reallocations = 0; //(growth of dynamic_layer.vertices, rects, or quads)
+		uint64_t gl_calls = 0; //(state-setting calls gl_state passed on to OpenGL...)
+		uint64_t gl_calls_elided = 0; //(...and skipped as redundant)
+	} draw_stats;
+
 	//matrix that maps from clip coordinates to court-space coordinates:
 	glm::mat3x2 clip_to_court = glm::mat3x2(1.0f);
 	// computed in draw() as the inverse of OBJECT_TO_CLIP
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Shader program that draws transformed, rotated, solid-colored rectangles -- one per instance:
+// (draw with glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count) -- corners come from gl_VertexID, not attributes)
+struct RectInstanceProgram {
+	RectInstanceProgram();
+	~RectInstanceProgram();
+
+	GLuint program = 0;
+
+	//Attribute (per-instance variable) locations:
+	GLuint Center_vec2 = -1U;
+	GLuint Radius_vec2 = -1U; //half the width and height (before rotation)
+	GLuint Angle_float = -1U; //counterclockwise rotation, in radians
+	GLuint Color_vec4 = -1U;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+};
@@ -0,0 +1,129 @@
+#include "Replay.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+void Replay::record(SnakeSim &sim, size_t g, Type type, float value) {
+	events.emplace_back(Event{updates, type, value});
+	apply(sim, g, type, value);
+}
+
+void Replay::apply(SnakeSim &sim, size_t g, Type type, float value) {
+	if (type == Restart) {
+		sim.setup(g);
+	} else if (type == LeftInput) {
+		sim.left_input[g] = int8_t(value);
+	} else if (type == RightPaddle) {
+		sim.right_paddle[g].y = value;
+	}
+}
+
+void Replay::play(SnakeSim &sim, size_t g) const {
+	auto event = events.begin();
+	for (uint32_t update = 0; ; ++update) {
+		while (event != events.end() && event->update == update) {
+			apply(sim, g, event->type, event->value);
+			++event;
+		}
+		if (update == updates) break;
+		sim.update(g, g + 1, elapsed);
+	}
+}
+
+//----- file format -----
+//(everything little-endian)
+// "snkr" magic, uint32 version,
+// uint32 seed, float elapsed, uint32 updates, uint64 checksum, uint32 event count,
+// then per event: uint32 update, uint8 type, float value
+
+static char const magic[4] = {'s', 'n', 'k', 'r'};
+static uint32_t const version = 1;
+
+static void write_bytes(std::ostream &to, uint64_t bits, uint32_t bytes) {
+	char buffer[8];
+	for (uint32_t i = 0; i < bytes; ++i) {
+		buffer[i] = char((bits >> (8 * i)) & 0xff);
+	}
+	to.write(buffer, bytes);
+}
+
+static uint64_t read_bytes(std::istream &from, uint32_t bytes) {
+	unsigned char buffer[8];
+	if (!from.read(reinterpret_cast< char * >(buffer), bytes)) {
+		throw std::runtime_error("Replay file ends early.");
+	}
+	uint64_t bits = 0;
+	for (uint32_t i = 0; i < bytes; ++i) {
+		bits |= uint64_t(buffer[i]) << (8 * i);
+	}
+	return bits;
+}
+
+static void write_float(std::ostream &to, float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, 4);
+	write_bytes(to, bits, 4);
+}
+
+static float read_float(std::istream &from) {
+	uint32_t bits = uint32_t(read_bytes(from, 4));
+	float value;
+	std::memcpy(&value, &bits, 4);
+	return value;
+}
+
+void Replay::save(std::string const &filename) const {
+	std::ofstream file(filename.c_str(), std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open replay file '" + filename + "' for writing.");
+	}
+	file.write(magic, 4);
+	write_bytes(file, version, 4);
+	write_bytes(file, seed, 4);
+	write_float(file, elapsed);
+	write_bytes(file, updates, 4);
+	write_bytes(file, checksum, 8);
+	write_bytes(file, events.size(), 4);
+	for (auto const &event : events) {
+		write_bytes(file, event.update, 4);
+		write_bytes(file, event.type, 1);
+		write_float(file, event.value);
+	}
+	if (!file) {
+		throw std::runtime_error("Failed to write replay file '" + filename + "'.");
+	}
+}
+
+Replay Replay::load(std::string const &filename) {
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open replay file '" + filename + "'.");
+	}
+	char file_magic[4];
+	if (!file.read(file_magic, 4) || std::memcmp(file_magic, magic, 4) != 0) {
+		throw std::runtime_error("'" + filename + "' is not a replay file.");
+	}
+	if (read_bytes(file, 4) != version) {
+		throw std::runtime_error("Replay file '" + filename + "' has an unknown version.");
+	}
+
+	Replay replay;
+	replay.seed = uint32_t(read_bytes(file, 4));
+	replay.elapsed = read_float(file);
+	replay.updates = uint32_t(read_bytes(file, 4));
+	replay.checksum = read_bytes(file, 8);
+	uint32_t count = uint32_t(read_bytes(file, 4));
+	replay.events.reserve(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		Event event;
+		event.update = uint32_t(read_bytes(file, 4));
+		event.type = Type(read_bytes(file, 1));
+		event.value = read_float(file);
+		if (!replay.events.empty() && event.update < replay.events.back().update) {
+			throw std::runtime_error("Replay file '" + filename + "' has events out of order.");
+		}
+		replay.events.emplace_back(event);
+	}
+	return replay;
+}
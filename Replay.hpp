@@ -0,0 +1,48 @@
+#pragma once
+
+#include "SnakeSim.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * Replay records everything needed to re-run a game of SnakeSim exactly:
+ * the seed, the update length, and every input PongMode applied to the game,
+ * stamped with the number of updates that had run before it.
+ *
+ * Inputs are stored as their effect on the game (e.g., the right paddle's new
+ * position) rather than as raw SDL events, so a replay doesn't depend on the
+ * window size it was recorded at.
+ */
+
+struct Replay {
+	enum Type : uint8_t {
+		Restart = 1, //SnakeSim::setup (value unused)
+		LeftInput = 2, //SnakeSim::left_input (value is -1, 0, or +1)
+		RightPaddle = 3, //SnakeSim::right_paddle y (value is the position)
+	};
+	struct Event {
+		uint32_t update; //applied after this many updates
+		Type type;
+		float value;
+	};
+
+	uint32_t seed = 0; //the game was SnakeSim(1, seed)
+	float elapsed = 1.0f / 60.0f; //seconds per update
+	uint32_t updates = 0; //updates run so far
+	uint64_t checksum = 0; //SnakeSim::checksum after all updates (set by the recorder before saving)
+	std::vector< Event > events;
+
+	//applies an input to game 'g' of 'sim' and appends it to the replay:
+	void record(SnakeSim &sim, size_t g, Type type, float value);
+	//applies an input to game 'g' of 'sim':
+	static void apply(SnakeSim &sim, size_t g, Type type, float value);
+
+	//re-runs the whole replay on game 'g' of 'sim' (which should have been made with 'seed'), as fast as possible:
+	void play(SnakeSim &sim, size_t g) const;
+
+	//NOTE: load and save throw on error
+	void save(std::string const &filename) const;
+	static Replay load(std::string const &filename);
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cassert>
+
+/*
+ * RingBuffer is a double-ended queue stored in one contiguous, power-of-two sized array.
+ * Storage only grows (doubling when full), so a buffer whose size stays bounded
+ * stops allocating once it has grown to fit.
+ *
+ * The elements occupy at most two contiguous runs of the array; spans() returns
+ * them so hot loops can walk flat memory instead of going through operator[].
+ */
+
+template< typename T >
+struct RingBuffer {
+	RingBuffer() = default;
+	explicit RingBuffer(size_t capacity_) { reserve(capacity_); }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	size_t capacity() const { return storage.size(); }
+
+	//element i counts from the front:
+	T &operator[](size_t i) { assert(i < count); return storage[(first + i) & mask]; }
+	T const &operator[](size_t i) const { assert(i < count); return storage[(first + i) & mask]; }
+
+	T &front() { return (*this)[0]; }
+	T const &front() const { return (*this)[0]; }
+	T &back() { return (*this)[count-1]; }
+	T const &back() const { return (*this)[count-1]; }
+
+	void push_front(T const &value) {
+		if (count == mask + 1) grow();
+		first = (first - 1) & mask;
+		storage[first] = value;
+		count += 1;
+	}
+	void push_back(T const &value) {
+		if (count == mask + 1) grow();
+		storage[(first + count) & mask] = value;
+		count += 1;
+	}
+	void emplace_back(T const &value) { push_back(value); }
+	void pop_front() {
+		assert(count > 0);
+		first = (first + 1) & mask;
+		count -= 1;
+	}
+	void pop_back() {
+		assert(count > 0);
+		count -= 1;
+	}
+
+	//removes all elements (keeping storage):
+	void clear() {
+		first = 0;
+		count = 0;
+	}
+
+	//makes sure at least 'capacity_' elements fit without allocating:
+	void reserve(size_t capacity_) {
+		if (capacity_ <= storage.size()) return;
+		size_t want = std::max< size_t >(storage.size(), 16);
+		while (want < capacity_) want *= 2;
+		reallocate(want);
+	}
+
+	//----- contiguous access -----
+	template< typename U >
+	struct BasicSpan {
+		U *data;
+		size_t size;
+		U *begin() const { return data; }
+		U *end() const { return data + size; }
+	};
+	typedef BasicSpan< T > Span;
+	typedef BasicSpan< T const > ConstSpan;
+
+	//elements [0, size()) are spans()[0] followed by spans()[1] (which may be empty):
+	std::array< Span, 2 > spans() {
+		size_t run = std::min(count, storage.size() - first);
+		return {{ Span{storage.data() + first, run}, Span{storage.data(), count - run} }};
+	}
+	std::array< ConstSpan, 2 > spans() const {
+		size_t run = std::min(count, storage.size() - first);
+		return {{ ConstSpan{storage.data() + first, run}, ConstSpan{storage.data(), count - run} }};
+	}
+
+	//----- storage -----
+	std::vector< T > storage; //size is zero or a power of two
+	size_t mask = size_t(-1); //storage.size() - 1 (so 'count == mask + 1' means full, even when empty)
+	size_t first = 0; //index in storage of element zero
+	size_t count = 0;
+
+	void grow() {
+		reallocate(storage.empty() ? 16 : storage.size() * 2);
+	}
+	void reallocate(size_t new_capacity) {
+		assert(new_capacity >= count && (new_capacity & (new_capacity - 1)) == 0);
+		std::vector< T > new_storage(new_capacity);
+		for (size_t i = 0; i < count; ++i) {
+			new_storage[i] = (*this)[i];
+		}
+		storage.swap(new_storage);
+		mask = new_capacity - 1;
+		first = 0;
+	}
+};
@@ -0,0 +1,244 @@
+#include "Rollback.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+constexpr uint32_t Rollback::head_vertices;
+
+//version for a Cells copy no snapshot uses:
+static uint32_t const unused_version = 0xffffffffu;
+
+Rollback::Rollback(SnakeSim const &sim, size_t g_, uint32_t capacity) : g(g_) {
+	assert(capacity > 0);
+	ring.resize(capacity);
+	//(held snapshots use at most 'capacity' different copies of the free list, including one being saved)
+	cells.resize(capacity);
+	OccupancyGrid const &grid = sim.body_cells[g];
+	for (Cells &c : cells) {
+		c.version = unused_version;
+		c.used = false;
+		c.free.reserve(grid.blocked.size());
+		c.slot.reserve(grid.blocked.size());
+	}
+	log.reserve(sim.snake_vertices[g].capacity());
+}
+
+void Rollback::clear() {
+	count = 0;
+	log.clear();
+	for (Cells &c : cells) {
+		c.version = unused_version;
+		c.used = false;
+	}
+}
+
+void Rollback::save(SnakeSim const &sim) {
+	RingBuffer< glm::vec2 > const &vertices = sim.snake_vertices[g];
+	uint32_t n = uint32_t(vertices.size());
+	assert(n > 0);
+	uint32_t head_serial = sim.head_serial[g];
+	uint32_t tail_serial = head_serial - (n - 1);
+
+	//serials only go backward when the game restarts, and the log can't span that:
+	if (count > 0 && (head_serial < at(0).head_serial || tail_serial < at(0).head_serial - (at(0).vertex_count - 1))) clear();
+
+	newest = (newest + 1) % ring.size();
+	count = std::min(count + 1, capacity());
+	Snapshot &s = at(0);
+
+	s.left_input = sim.left_input[g];
+	s.running = sim.running[g];
+	s.red_fruit_exists = sim.red_fruit_exists[g];
+	s.last_collided = sim.last_collided[g];
+	s.left_paddle = sim.left_paddle[g];
+	s.right_paddle = sim.right_paddle[g];
+	s.snake_velocity = sim.snake_velocity[g];
+	s.snake_length = sim.snake_length[g];
+	s.tail_length = sim.tail_length[g];
+	s.neck_error = sim.neck_error[g];
+	s.green_fruit = sim.green_fruit[g];
+	s.red_fruit = sim.red_fruit[g];
+	s.length_update_buffer = sim.length_update_buffer[g];
+	s.health = sim.health[g];
+	s.rng = sim.rng[g];
+	s.ticks = sim.ticks[g];
+	s.time = sim.time[g];
+	s.paddle_misses = sim.paddle_misses[g];
+	s.body_hits = sim.body_hits[g];
+	s.green_fruit_eaten = sim.green_fruit_eaten[g];
+	s.red_fruit_heals = sim.red_fruit_heals[g];
+	s.arc_total = sim.body_segments[g].arc_total;
+
+	s.head_serial = head_serial;
+	s.vertex_count = n;
+	for (uint32_t i = 0; i < std::min(n, head_vertices); ++i) {
+		s.head[i] = vertices[i];
+	}
+	s.tail = vertices[n - 1];
+
+	//log the vertices that are now far enough behind the head that they won't change (up to serial head_serial - head_vertices);
+	// serials at or past the tail (which moves) aren't in any snapshot's middle, so they just hold a place:
+	if (log.empty()) log_first = tail_serial + 1;
+	for (uint32_t serial = log_first + uint32_t(log.size()); serial + head_vertices <= head_serial; ++serial) {
+		log.push_back(vertices[serial > tail_serial ? head_serial - serial : n - 1]);
+	}
+	//...and forget the ones no held snapshot needs any more:
+	Snapshot const &oldest = at(count - 1);
+	uint32_t oldest_tail = oldest.head_serial - (oldest.vertex_count - 1);
+	while (!log.empty() && log_first <= oldest_tail) {
+		log.pop_front();
+		log_first += 1;
+	}
+
+	//copy the fruit grid's free list if it changed, into a copy no held snapshot uses:
+	OccupancyGrid const &grid = sim.body_cells[g];
+	s.cells_version = grid.version;
+	if (count > 1 && at(1).cells_version == grid.version) return; //(the usual case -- same as last time)
+	Cells *found = nullptr, *spare = nullptr;
+	for (Cells &c : cells) {
+		c.used = false;
+		for (uint32_t age = 1; age < count && !c.used; ++age) {
+			c.used = (at(age).cells_version == c.version);
+		}
+		if (c.used && c.version == grid.version) found = &c;
+		if (!c.used) spare = &c;
+	}
+	if (!found) {
+		assert(spare);
+		spare->version = grid.version;
+		spare->free.assign(grid.free.begin(), grid.free.end());
+		spare->slot.assign(grid.slot.begin(), grid.slot.end());
+	}
+}
+
+bool Rollback::restore(SnakeSim &sim, uint32_t age) {
+	if (age >= count) return false;
+	newest = (newest + uint32_t(ring.size()) - age) % ring.size();
+	count -= age;
+	Snapshot const &s = at(0);
+
+	//copies of the free list only the dropped snapshots used might reuse a version number later, so retire them:
+	Cells const *cells_copy = nullptr;
+	for (Cells &c : cells) {
+		c.used = false;
+		for (uint32_t a = 0; a < count && !c.used; ++a) {
+			c.used = (at(a).cells_version == c.version);
+		}
+		if (!c.used) c.version = unused_version;
+		if (c.version == s.cells_version) cells_copy = &c;
+	}
+	assert(cells_copy);
+
+	//the snapshot's body is head[0, head_count), then the middle (serials [middle_first, middle_last], from the log), then the tail:
+	uint32_t head_count = std::min(s.vertex_count - 1, head_vertices);
+	uint32_t tail_serial = s.head_serial - (s.vertex_count - 1);
+	uint32_t middle_first = tail_serial + 1;
+	uint32_t middle_last = s.head_serial - head_count; //(middle is empty if middle_last < middle_first)
+	assert(middle_last < middle_first || (log_first <= middle_first && middle_last < log_first + log.size()));
+	//(log entries past the middle came from updates that are being undone)
+	while (!log.empty() && log_first + log.size() > middle_last + 1) log.pop_back();
+
+	//the snapshot's vertex with serial 'serial':
+	auto snapshot_vertex = [&](uint32_t serial) {
+		uint32_t i = s.head_serial - serial;
+		if (i < head_count) return s.head[i];
+		if (serial == tail_serial) return s.tail;
+		return log[serial - log_first];
+	};
+
+	//find vertices [same_first, same_last] the game and the snapshot share, so only the ends need to change
+	// (pops and pushes move segments in and out of body_grid and body_cells, which costs more the longer they are):
+	RingBuffer< glm::vec2 > &vertices = sim.snake_vertices[g];
+	uint32_t now_head = sim.head_serial[g];
+	uint32_t now_tail = now_head - uint32_t(vertices.size() - 1);
+	auto same = [&](uint32_t serial) {
+		return vertices[now_head - serial] == snapshot_vertex(serial);
+	};
+	bool shared = false;
+	uint32_t same_first = 0, same_last = 0;
+	if (middle_last >= middle_first && now_head >= s.head_serial && now_tail >= tail_serial && now_tail < middle_last) {
+		//the game still has (unmoved) vertices (now_tail, middle_last], and perhaps a few more past them:
+		shared = true;
+		same_first = now_tail + 1;
+		same_last = middle_last;
+		while (same_last < s.head_serial && same(same_last + 1)) same_last += 1;
+	} else {
+		//...otherwise (e.g., a short body, which is most of them) compare, from the head end:
+		uint32_t first = std::max(now_tail, tail_serial), last = std::min(now_head, s.head_serial);
+		for (uint32_t serial = last + 1; serial > first && !shared; --serial) {
+			shared = same(serial - 1);
+			same_last = serial - 1;
+		}
+		same_first = same_last;
+		while (shared && same_first > first && same(same_first - 1)) same_first -= 1;
+	}
+
+	if (shared) {
+		//pop back to just past the shared vertices, move the ends to the snapshot's (the end vertices are only in
+		// the moving head and tail segments, which aren't in either grid, so they can just be set), then push the rest:
+		uint32_t keep_head = std::min(same_last + 1, s.head_serial);
+		uint32_t keep_tail = std::max(same_first, tail_serial + 1) - 1;
+		while (sim.head_serial[g] > keep_head) sim.pop_head(g);
+		while (sim.head_serial[g] - uint32_t(vertices.size() - 1) < keep_tail) sim.pop_tail(g);
+		if (sim.head_serial[g] == keep_head) vertices.front() = snapshot_vertex(keep_head);
+		if (sim.head_serial[g] - uint32_t(vertices.size() - 1) == keep_tail) vertices.back() = snapshot_vertex(keep_tail);
+		for (uint32_t serial = sim.head_serial[g] + 1; serial <= s.head_serial; ++serial) {
+			sim.push_head(g, snapshot_vertex(serial));
+		}
+		for (uint32_t serial = sim.head_serial[g] - uint32_t(vertices.size() - 1); serial > tail_serial; ) {
+			sim.push_tail(g, snapshot_vertex(--serial));
+		}
+	} else {
+		//rebuild the whole body -- taking the current one apart a segment at a time, so only the grid cells it
+		// touches are visited (clearing body_grid and body_cells would walk every cell):
+		while (vertices.size() > 1) sim.pop_tail(g);
+		assert(sim.body_grid[g].count == 0 && sim.body_segments[g].ax.empty());
+		vertices.front() = s.tail;
+		sim.head_serial[g] = tail_serial;
+		for (uint32_t serial = tail_serial + 1; serial <= s.head_serial; ++serial) {
+			sim.push_head(g, snapshot_vertex(serial));
+		}
+	}
+	assert(sim.head_serial[g] == s.head_serial && vertices.size() == s.vertex_count);
+
+	OccupancyGrid &grid = sim.body_cells[g];
+	assert(grid.free.size() == cells_copy->free.size());
+	std::copy(cells_copy->free.begin(), cells_copy->free.end(), grid.free.begin());
+	std::copy(cells_copy->slot.begin(), cells_copy->slot.end(), grid.slot.begin());
+	grid.version = s.cells_version;
+
+	sim.left_input[g] = s.left_input;
+	sim.running[g] = s.running;
+	sim.red_fruit_exists[g] = s.red_fruit_exists;
+	sim.last_collided[g] = s.last_collided;
+	sim.left_paddle[g] = s.left_paddle;
+	sim.right_paddle[g] = s.right_paddle;
+	sim.snake_velocity[g] = s.snake_velocity;
+	sim.snake_length[g] = s.snake_length;
+	sim.tail_length[g] = s.tail_length;
+	sim.neck_error[g] = s.neck_error;
+	sim.green_fruit[g] = s.green_fruit;
+	sim.red_fruit[g] = s.red_fruit;
+	sim.length_update_buffer[g] = s.length_update_buffer;
+	sim.health[g] = s.health;
+	sim.rng[g] = s.rng;
+	sim.ticks[g] = s.ticks;
+	sim.time[g] = s.time;
+	sim.paddle_misses[g] = s.paddle_misses;
+	sim.body_hits[g] = s.body_hits;
+	sim.green_fruit_eaten[g] = s.green_fruit_eaten;
+	sim.red_fruit_heals[g] = s.red_fruit_heals;
+	//arcs are measured from wherever the body started, so must line up with the snapshot's -- a rebuilt body starts
+	// at zero, and the ends' pops and pushes needn't land where the original updates did (e.g., a merge in push_head),
+	// so move every arc along by the difference (arc_total alone would leave total_length, and so body_length, wrong):
+	SnakeSim::BodySegments &body = sim.body_segments[g];
+	double shift = s.arc_total - body.arc_total;
+	if (shift != 0.0) {
+		for (auto const &span : body.arc.spans()) {
+			for (double &arc : span) arc += shift;
+		}
+		body.arc_total = s.arc_total;
+	}
+
+	return true;
+}
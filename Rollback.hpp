@@ -0,0 +1,101 @@
+#pragma once
+
+#include "SnakeSim.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+/*
+ * Rollback keeps snapshots of the last few updates of one SnakeSim game, so the
+ * game can be put back to any of them and re-simulated (for rollback netcode or
+ * rewinding).
+ *
+ * Snapshots live in a ring allocated up front, and saving one copies only what
+ * an update can change: the per-game fields, the few vertices at the head end
+ * (bounces add vertices there and simplification rewrites them), and the tail
+ * vertex. The vertices in between never change once they are behind the head,
+ * so each is copied once, into a log (by serial number) shared by all snapshots.
+ * The fruit spawning grid's free list is copied only on updates that change it,
+ * since its order decides where fruit spawns.
+ *
+ * Restoring pops the snake back to the vertices it shares with the snapshot
+ * and pushes the rest of the snapshot's back on (updating body_grid and
+ * friends as it goes). The end vertices are just moved, since the head and tail
+ * segments aren't in those grids, and only a body that shares no vertex with
+ * the snapshot is taken apart and rebuilt. Since a segment costs more to move
+ * in and out of the grids the longer it is, this matters even for short bodies
+ * (the usual case), whose few segments are long. So restoring costs about as
+ * much as re-inserting the segments that changed: 1-4 us in bench rollback,
+ * where copying the game costs 2-400 us.
+ */
+
+struct Rollback {
+	//holds up to 'capacity' snapshots of game 'g' of 'sim':
+	Rollback(SnakeSim const &sim, size_t g, uint32_t capacity = 16);
+
+	//number of snapshots held (the newest is age zero):
+	uint32_t size() const { return count; }
+	uint32_t capacity() const { return uint32_t(ring.size()); }
+
+	//snapshots the game (dropping the oldest snapshot if the ring is full):
+	void save(SnakeSim const &sim);
+	//puts the game back as it was in the snapshot 'age' saves ago and drops the newer ones
+	// (so that snapshot becomes age zero); returns false (and changes nothing) if 'age' is out of range:
+	bool restore(SnakeSim &sim, uint32_t age);
+	//drops every snapshot:
+	void clear();
+
+	size_t g;
+
+	//vertices [0, head_vertices) are kept in each snapshot:
+	static constexpr uint32_t head_vertices = 4;
+
+	struct Snapshot {
+		//per-game fields of SnakeSim (other than the body):
+		int8_t left_input;
+		uint8_t running;
+		uint8_t red_fruit_exists;
+		uint8_t last_collided;
+		glm::vec2 left_paddle, right_paddle;
+		glm::vec2 snake_velocity;
+		float snake_length;
+		float tail_length;
+		float neck_error;
+		glm::vec2 green_fruit, red_fruit;
+		float length_update_buffer;
+		int health;
+		CounterRng rng;
+		uint32_t ticks;
+		float time;
+		uint32_t paddle_misses, body_hits, green_fruit_eaten, red_fruit_heals;
+		double arc_total; //(of body_segments)
+
+		//the body: serials [head_serial - (vertex_count - 1), head_serial]:
+		uint32_t head_serial;
+		uint32_t vertex_count;
+		std::array< glm::vec2, head_vertices > head; //vertices [0, min(vertex_count, head_vertices))
+		glm::vec2 tail;
+
+		uint32_t cells_version; //body_cells.version (see 'cells')
+	};
+	std::vector< Snapshot > ring;
+	uint32_t newest = 0; //index in 'ring' of the age zero snapshot
+	uint32_t count = 0;
+	Snapshot &at(uint32_t age) { return ring[(newest + uint32_t(ring.size()) - age) % ring.size()]; }
+
+	//vertices that are behind the head, by serial: log[i] is the vertex with serial log_first + i
+	// (covers the middle of every held snapshot's body):
+	RingBuffer< glm::vec2 > log;
+	uint32_t log_first = 0;
+
+	//copies of body_cells.free and .slot (each snapshot uses the one with its cells_version):
+	struct Cells {
+		uint32_t version;
+		bool used;
+		std::vector< uint16_t > free, slot;
+	};
+	std::vector< Cells > cells;
+};
@@ -0,0 +1,97 @@
+#include "SegmentGrid.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cassert>
+
+SegmentGrid::SegmentGrid(glm::vec2 const &min_, glm::vec2 const &max_, float cell_size_) : min(min_) {
+	assert(cell_size_ > 0.0f && max_.x > min_.x && max_.y > min_.y);
+	size.x = std::max(1, int((max_.x - min_.x) / cell_size_));
+	size.y = std::max(1, int((max_.y - min_.y) / cell_size_));
+	//stretch cells slightly so the grid covers exactly [min, max]:
+	cell_size = glm::vec2((max_.x - min_.x) / size.x, (max_.y - min_.y) / size.y);
+	cells.resize(size.x * size.y);
+}
+
+glm::ivec2 SegmentGrid::cell_of(glm::vec2 const &pt) const {
+	glm::ivec2 ret;
+	ret.x = std::min(std::max(int(std::floor((pt.x - min.x) / cell_size.x)), 0), size.x - 1);
+	ret.y = std::min(std::max(int(std::floor((pt.y - min.y) / cell_size.y)), 0), size.y - 1);
+	return ret;
+}
+
+template< typename Fn >
+void SegmentGrid::for_cells(glm::vec2 const &a, glm::vec2 const &b, Fn const &fn) const {
+	glm::ivec2 ca = cell_of(a);
+	glm::ivec2 cb = cell_of(b);
+
+	//small slack so points exactly on cell boundaries land in both neighbors:
+	float eps = 1e-4f * cell_size.y;
+
+	if (ca.x == cb.x || std::abs(b.x - a.x) < 1e-6f) {
+		//(nearly) vertical; every cell in the covered columns between the endpoints:
+		int y0 = cell_of(glm::vec2(a.x, std::min(a.y, b.y) - eps)).y;
+		int y1 = cell_of(glm::vec2(a.x, std::max(a.y, b.y) + eps)).y;
+		for (int x = std::min(ca.x, cb.x); x <= std::max(ca.x, cb.x); ++x) {
+			for (int y = y0; y <= y1; ++y) {
+				fn(y * size.x + x);
+			}
+		}
+		return;
+	}
+
+	//otherwise walk the columns, finding the span of rows the segment covers in each:
+	float seg_min_x = std::min(a.x, b.x);
+	float seg_max_x = std::max(a.x, b.x);
+	float slope = (b.y - a.y) / (b.x - a.x);
+	float const inf = std::numeric_limits< float >::infinity();
+	for (int x = std::min(ca.x, cb.x); x <= std::max(ca.x, cb.x); ++x) {
+		//border columns also hold everything clamped into them:
+		float left = (x == 0 ? -inf : min.x + x * cell_size.x);
+		float right = (x == size.x - 1 ? inf : min.x + (x + 1) * cell_size.x);
+		float x0 = std::max(seg_min_x, left);
+		float x1 = std::min(seg_max_x, right);
+		float y0 = a.y + (x0 - a.x) * slope;
+		float y1 = a.y + (x1 - a.x) * slope;
+		int row0 = cell_of(glm::vec2(a.x, std::min(y0, y1) - eps)).y;
+		int row1 = cell_of(glm::vec2(a.x, std::max(y0, y1) + eps)).y;
+		for (int y = row0; y <= row1; ++y) {
+			fn(y * size.x + x);
+		}
+	}
+}
+
+void SegmentGrid::insert(uint32_t id, glm::vec2 const &a, glm::vec2 const &b) {
+	Entry entry;
+	entry.id = id;
+	entry.a = a;
+	entry.b = b;
+	for_cells(a, b, [&](int c){
+		cells[c].emplace_back(entry);
+	});
+	count += 1;
+}
+
+void SegmentGrid::remove(uint32_t id, glm::vec2 const &a, glm::vec2 const &b) {
+	for_cells(a, b, [&](int c){
+		std::vector< Entry > &cell = cells[c];
+		for (size_t i = 0; i < cell.size(); ++i) {
+			if (cell[i].id == id) {
+				cell[i] = cell.back();
+				cell.pop_back();
+				break;
+			}
+		}
+	});
+	assert(count > 0);
+	count -= 1;
+}
+
+void SegmentGrid::clear() {
+	//(keeps each cell's capacity, so a restarted game doesn't reallocate)
+	for (auto &cell : cells) {
+		cell.clear();
+	}
+	count = 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * SegmentGrid is a uniform-grid spatial hash of line segments over a fixed
+ * rectangle, used to find snake body segments near the head without scanning
+ * the whole body.
+ *
+ * Segments are registered (by caller-chosen id) in every cell they pass
+ * through, so a query only needs to look at the cells around the query point.
+ * Points outside the rectangle are clamped to the border cells.
+ */
+
+struct SegmentGrid {
+	//grid covering [min, max], with cells no smaller than 'cell_size':
+	SegmentGrid(glm::vec2 const &min, glm::vec2 const &max, float cell_size);
+
+	struct Entry {
+		uint32_t id;
+		glm::vec2 a, b;
+	};
+
+	void insert(uint32_t id, glm::vec2 const &a, glm::vec2 const &b);
+	//'a' and 'b' must be the same endpoints the segment was inserted with:
+	void remove(uint32_t id, glm::vec2 const &a, glm::vec2 const &b);
+	void clear();
+
+	//calls 'fn(Entry const &)' for every segment registered in a cell overlapping
+	// the square of half-size 'radius' around 'pt'; stops early (and returns true) if fn returns true.
+	//(a segment overlapping several of these cells may be visited more than once)
+	template< typename Fn >
+	bool any_near(glm::vec2 const &pt, float radius, Fn const &fn) const {
+		glm::ivec2 lo = cell_of(pt - glm::vec2(radius));
+		glm::ivec2 hi = cell_of(pt + glm::vec2(radius));
+		for (int y = lo.y; y <= hi.y; ++y) {
+			for (int x = lo.x; x <= hi.x; ++x) {
+				for (Entry const &e : cells[y * size.x + x]) {
+					if (fn(e)) return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	glm::vec2 min;
+	glm::vec2 cell_size;
+	glm::ivec2 size; //number of cells in x and y
+	std::vector< std::vector< Entry > > cells;
+	size_t count = 0; //number of segments currently registered
+
+	glm::ivec2 cell_of(glm::vec2 const &pt) const;
+
+	//calls 'fn(int cell_index)' for each cell the segment passes through:
+	template< typename Fn >
+	void for_cells(glm::vec2 const &a, glm::vec2 const &b, Fn const &fn) const;
+};
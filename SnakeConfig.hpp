@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/*
+ * The game's tuning constants.
+ *
+ * SnakeConfig holds them at runtime (so tools like 'sweep' can try other values);
+ * DefaultConfig is the shipped game, with every value known at compile time.
+ * SnakeSim::update runs code specialized for DefaultConfig whenever its config
+ * matches, so the interactive game pays nothing for being tunable.
+ */
+
+struct DefaultConfig {
+	static constexpr glm::vec2 court_size = glm::vec2(9.6f, 6.0f);
+	static constexpr float green_fruit_length_increase = 0.5f;
+	static constexpr int initial_health = 5;
+	static constexpr int collision_damage = 2;
+	static constexpr int paddle_miss_damage = 1;
+	static constexpr float red_fruit_chance = 0.101f;
+	static constexpr float initial_snake_length = 10.5f;
+	//body vertices are merged away while the body stays within this distance of the path the head took:
+	static constexpr float simplify_tolerance = 0.01f;
+};
+
+struct SnakeConfig {
+	glm::vec2 court_size = DefaultConfig::court_size;
+	float green_fruit_length_increase = DefaultConfig::green_fruit_length_increase;
+	int initial_health = DefaultConfig::initial_health;
+	int collision_damage = DefaultConfig::collision_damage;
+	int paddle_miss_damage = DefaultConfig::paddle_miss_damage;
+	float red_fruit_chance = DefaultConfig::red_fruit_chance;
+	float initial_snake_length = DefaultConfig::initial_snake_length;
+	float simplify_tolerance = DefaultConfig::simplify_tolerance; //(negative to keep every vertex)
+
+	//does this match DefaultConfig exactly?
+	bool is_default() const {
+		return court_size == DefaultConfig::court_size
+			&& green_fruit_length_increase == DefaultConfig::green_fruit_length_increase
+			&& initial_health == DefaultConfig::initial_health
+			&& collision_damage == DefaultConfig::collision_damage
+			&& paddle_miss_damage == DefaultConfig::paddle_miss_damage
+			&& red_fruit_chance == DefaultConfig::red_fruit_chance
+			&& initial_snake_length == DefaultConfig::initial_snake_length
+			&& simplify_tolerance == DefaultConfig::simplify_tolerance;
+	}
+};
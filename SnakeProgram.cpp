@@ -0,0 +1,65 @@
+#include "SnakeProgram.hpp"
+
+#include "gl_compile_program.hpp"
+#include "gl_errors.hpp"
+
+SnakeProgram::SnakeProgram() {
+	program = gl_compile_program(
+		//vertex shader:
+		"#version 330\n"
+		"uniform mat4 OBJECT_TO_CLIP;\n"
+		"uniform samplerBuffer VERTICES;\n"
+		"uniform vec2 SIZE;\n"
+		"uniform vec4 COLOR;\n"
+		"out vec4 color;\n"
+		"void main() {\n"
+		"	int segment = gl_VertexID / 6;\n"
+		"	int corner = gl_VertexID - 6 * segment;\n"
+		//(same arguments, and same arithmetic in the same order, as PongMode's draw_unaligned_rectangle(vertex i+1, vertex i)):
+		"	vec2 vertex1 = texelFetch(VERTICES, segment + 1).xy;\n"
+		"	vec2 vertex2 = texelFetch(VERTICES, segment).xy;\n"
+		"	float len = distance(vertex1, vertex2);\n"
+		"	float x_ratio = abs(vertex1.x - vertex2.x) / len;\n"
+		"	float y_ratio = abs(vertex1.y - vertex2.y) / len;\n"
+		//the quad's corners, as triangles (0 1 2) (0 2 3), go around from the left end of the segment:
+		"	int k = (corner < 3 ? corner : (corner == 3 ? 0 : corner - 2));\n"
+		"	vec2 left = (vertex1.x - vertex2.x < 0.0 ? vertex1 : vertex2);\n"
+		"	vec2 right = (vertex1.x - vertex2.x < 0.0 ? vertex2 : vertex1);\n"
+		"	vec2 end = (k == 0 || k == 3 ? left : right);\n"
+		"	float along = (k == 0 || k == 3 ? -1.0 : 1.0);\n"
+		"	float side = (k == 0 || k == 1 ? 1.0 : -1.0);\n"
+		//(going up to the right, or flat, the quad's y follows its x; going down to the right, it's mirrored)
+		"	float rising = (vertex1.y == vertex2.y || (vertex1.x - vertex2.x) / (vertex1.y - vertex2.y) > 0.0 ? 1.0 : -1.0);\n"
+		"	vec2 at = vec2(\n"
+		"		end.x + along * (SIZE.x * x_ratio) + side * (SIZE.y * y_ratio),\n"
+		"		end.y + rising * along * (SIZE.x * y_ratio) - rising * side * (SIZE.y * x_ratio)\n"
+		"	);\n"
+		"	gl_Position = OBJECT_TO_CLIP * vec4(at, 0.0, 1.0);\n"
+		"	color = COLOR;\n"
+		"}\n"
+	,
+		//fragment shader:
+		"#version 330\n"
+		"in vec4 color;\n"
+		"out vec4 fragColor;\n"
+		"void main() {\n"
+		"	fragColor = color;\n"
+		"}\n"
+	);
+
+	//look up the locations of uniforms:
+	OBJECT_TO_CLIP_mat4 = glGetUniformLocation(program, "OBJECT_TO_CLIP");
+	SIZE_vec2 = glGetUniformLocation(program, "SIZE");
+	COLOR_vec4 = glGetUniformLocation(program, "COLOR");
+	GLuint VERTICES_samplerBuffer = glGetUniformLocation(program, "VERTICES");
+
+	//set VERTICES to always refer to texture binding zero:
+	glUseProgram(program);
+	glUniform1i(VERTICES_samplerBuffer, 0);
+	glUseProgram(0);
+}
+
+SnakeProgram::~SnakeProgram() {
+	glDeleteProgram(program);
+	program = 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "GL.hpp"
+
+//Shader program that draws a snake's body straight from its vertices, which it reads from a buffer texture:
+// (draw with glDrawArrays(GL_TRIANGLES, 0, 6 * segments) and no vertex attributes -- segment i is the quad
+//  between vertices i and i+1, built from gl_VertexID just as PongMode's draw_unaligned_rectangle builds it)
+struct SnakeProgram {
+	SnakeProgram();
+	~SnakeProgram();
+
+	GLuint program = 0;
+
+	//Uniform (per-invocation variable) locations:
+	GLuint OBJECT_TO_CLIP_mat4 = -1U;
+	GLuint SIZE_vec2 = -1U; //how far each quad reaches past its segment's ends (x) and to either side (y)
+	GLuint COLOR_vec4 = -1U;
+
+	//Textures:
+	//TEXTURE0 - GL_TEXTURE_BUFFER (format GL_RG32F) of the snake's vertices, head first
+};
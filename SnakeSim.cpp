@@ -0,0 +1,902 @@
+#include "SnakeSim.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <limits>
+
+//out-of-class definitions so the constants may be bound to references (required pre-C++17):
+constexpr glm::vec2 DefaultConfig::court_size;
+constexpr float DefaultConfig::green_fruit_length_increase;
+constexpr int DefaultConfig::initial_health;
+constexpr int DefaultConfig::collision_damage;
+constexpr int DefaultConfig::paddle_miss_damage;
+constexpr float DefaultConfig::red_fruit_chance;
+constexpr float DefaultConfig::initial_snake_length;
+constexpr float DefaultConfig::simplify_tolerance;
+
+constexpr glm::vec2 SnakeSim::paddle_size;
+constexpr float SnakeSim::snake_radius;
+constexpr glm::vec2 SnakeSim::snake_size;
+constexpr float SnakeSim::fruit_radius;
+constexpr glm::vec2 SnakeSim::fruit_size;
+constexpr int SnakeSim::red_fruit_heal;
+constexpr float SnakeSim::paddle_step;
+constexpr float SnakeSim::max_speed;
+constexpr size_t SnakeSim::simd_body_limit;
+constexpr uint32_t SnakeSim::max_bounces;
+
+SnakeSim::SnakeSim(size_t count, uint32_t seed, SnakeConfig const &config_) : config(config_) {
+	add_games(count, seed);
+}
+
+size_t SnakeSim::add_games(size_t count, uint32_t seed) {
+	size_t first = size();
+	size_t total = first + count;
+
+	left_input.resize(total, 0);
+	running.resize(total);
+	left_paddle.resize(total);
+	right_paddle.resize(total);
+	snake_velocity.resize(total);
+	snake_length.resize(total);
+	snake_vertices.resize(total);
+	head_serial.resize(total);
+	//cells as wide as a collision query, so each query looks at no more than 3x3 cells:
+	body_grid.resize(total, SegmentGrid(-config.court_size, config.court_size, 4.0f * snake_radius));
+	body_segments.resize(total);
+	//fruit spawns in the central part of the court, in cells clear of the body by at least a snake + fruit radius:
+	glm::vec2 const spawn_area = 0.8f * config.court_size;
+	body_cells.resize(total, OccupancyGrid(-spawn_area, spawn_area, fruit_radius, snake_radius + fruit_radius));
+	tail_length.resize(total);
+	neck_error.resize(total);
+	green_fruit.resize(total);
+	red_fruit_exists.resize(total);
+	red_fruit.resize(total);
+	length_update_buffer.resize(total);
+	last_collided.resize(total);
+	health.resize(total);
+	ticks.resize(total);
+	time.resize(total);
+	paddle_misses.resize(total);
+	body_hits.resize(total);
+	green_fruit_eaten.resize(total);
+	red_fruit_heals.resize(total);
+
+	rng.reserve(total);
+	for (size_t g = first; g < total; ++g) {
+		rng.emplace_back(uint32_t(seed + g));
+		setup(g);
+	}
+
+	return first;
+}
+
+void SnakeSim::setup(size_t g) {
+	snake_length[g] = config.initial_snake_length;
+
+	// Initialize snake position
+	place(g, glm::vec2(0.0f, 0.0f), glm::vec2(-1.0f, 0.0f));
+	length_update_buffer[g] = 0.0f;
+
+	left_paddle[g] = glm::vec2(-config.court_size.x + 0.5f, 0.0f);
+	right_paddle[g] = glm::vec2(config.court_size.x - 0.5f, 0.0f);
+
+	// Generate initial green_fruit position
+	green_fruit[g] = spawn_fruit(g);
+
+	red_fruit_exists[g] = false;
+
+	last_collided[g] = false;
+
+	health[g] = config.initial_health;
+
+	running[g] = true;
+
+	ticks[g] = 0;
+	time[g] = 0.0f;
+	paddle_misses[g] = 0;
+	body_hits[g] = 0;
+	green_fruit_eaten[g] = 0;
+	red_fruit_heals[g] = 0;
+}
+
+void SnakeSim::place(size_t g, glm::vec2 const &head, glm::vec2 const &direction) {
+	snake_vertices[g].clear();
+	body_grid[g].clear();
+	body_segments[g].clear();
+	body_cells[g].clear();
+	head_serial[g] = 0;
+	neck_error[g] = 0.0f;
+	snake_vertices[g].emplace_back(head - direction * snake_length[g]);
+	push_head(g, head);
+	snake_velocity[g] = direction;
+}
+
+uint64_t SnakeSim::checksum(size_t g) const {
+	//FNV-1a over the bytes of the state:
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	auto add = [&hash](void const *data, size_t size) {
+		for (size_t i = 0; i < size; ++i) {
+			hash = (hash ^ static_cast< uint8_t const * >(data)[i]) * 0x100000001b3ULL;
+		}
+	};
+	add(&running[g], sizeof(running[g]));
+	add(&left_paddle[g], sizeof(left_paddle[g]));
+	add(&right_paddle[g], sizeof(right_paddle[g]));
+	add(&snake_velocity[g], sizeof(snake_velocity[g]));
+	add(&snake_length[g], sizeof(snake_length[g]));
+	for (auto const &span : snake_vertices[g].spans()) {
+		add(span.data, span.size * sizeof(glm::vec2));
+	}
+	add(&green_fruit[g], sizeof(green_fruit[g]));
+	add(&red_fruit_exists[g], sizeof(red_fruit_exists[g]));
+	add(&red_fruit[g], sizeof(red_fruit[g]));
+	add(&length_update_buffer[g], sizeof(length_update_buffer[g]));
+	add(&neck_error[g], sizeof(neck_error[g]));
+	add(&last_collided[g], sizeof(last_collided[g]));
+	add(&health[g], sizeof(health[g]));
+	add(&ticks[g], sizeof(ticks[g]));
+	add(&rng[g].counter, sizeof(rng[g].counter));
+	return hash;
+}
+
+void SnakeSim::damaged(size_t g, int damage) {
+	health[g] -= damage;
+	if(health[g] < 0) {
+		running[g] = false;
+	}
+}
+
+// Inline helper function
+// not sure why vec.length() always returns 2
+static float inline veclength(glm::vec2 vector) {
+	return std::pow(vector.x * vector.x + vector.y * vector.y, 0.5f);
+}
+
+// squared distance from point 'pt' to the segment from 'a' to 'b':
+// (same operations as first_segment_within, so results agree exactly)
+static float inline segment_distance2(glm::vec2 const &pt, glm::vec2 const &a, glm::vec2 const &b) {
+	glm::vec2 ab = b - a;
+	glm::vec2 ap = pt - a;
+	float len2 = ab.x * ab.x + ab.y * ab.y;
+	float inv_len2 = (len2 > 0.0f ? 1.0f / len2 : 0.0f);
+	float t = (ap.x * ab.x + ap.y * ab.y) * inv_len2;
+	t = std::min(std::max(t, 0.0f), 1.0f);
+	float ex = ap.x - t * ab.x;
+	float ey = ap.y - t * ab.y;
+	return ex * ex + ey * ey;
+}
+
+void SnakeSim::BodySegments::clear() {
+	ax.clear();
+	ay.clear();
+	dx.clear();
+	dy.clear();
+	inv_len2.clear();
+	length.clear();
+	inv_length.clear();
+	arc.clear();
+	arc_total = 0.0;
+}
+
+void SnakeSim::BodySegments::push_front(glm::vec2 const &a, glm::vec2 const &b) {
+	glm::vec2 ab = b - a;
+	float len2 = ab.x * ab.x + ab.y * ab.y;
+	float len = std::sqrt(len2);
+	ax.push_front(a.x);
+	ay.push_front(a.y);
+	dx.push_front(ab.x);
+	dy.push_front(ab.y);
+	inv_len2.push_front(len2 > 0.0f ? 1.0f / len2 : 0.0f);
+	length.push_front(len);
+	inv_length.push_front(len > 0.0f ? 1.0f / len : 0.0f);
+	arc.push_front(arc_total);
+	arc_total += len;
+}
+
+void SnakeSim::BodySegments::push_back(glm::vec2 const &a, glm::vec2 const &b) {
+	glm::vec2 ab = b - a;
+	float len2 = ab.x * ab.x + ab.y * ab.y;
+	float len = std::sqrt(len2);
+	//(the new element's head-side end is the old back's tail-side end)
+	double end = (arc.empty() ? arc_total : arc.back());
+	ax.push_back(a.x);
+	ay.push_back(a.y);
+	dx.push_back(ab.x);
+	dy.push_back(ab.y);
+	inv_len2.push_back(len2 > 0.0f ? 1.0f / len2 : 0.0f);
+	length.push_back(len);
+	inv_length.push_back(len > 0.0f ? 1.0f / len : 0.0f);
+	arc.push_back(end - len);
+}
+
+void SnakeSim::BodySegments::pop_front() {
+	arc_total = arc.front();
+	ax.pop_front();
+	ay.pop_front();
+	dx.pop_front();
+	dy.pop_front();
+	inv_len2.pop_front();
+	length.pop_front();
+	inv_length.pop_front();
+	arc.pop_front();
+}
+
+void SnakeSim::BodySegments::pop_back() {
+	ax.pop_back();
+	ay.pop_back();
+	dx.pop_back();
+	dy.pop_back();
+	inv_len2.pop_back();
+	length.pop_back();
+	inv_length.pop_back();
+	arc.pop_back();
+}
+
+glm::vec2 SnakeSim::BodySegments::point_along(float along) const {
+	assert(size() > 0);
+	double target = arc_total - double(std::max(along, 0.0f));
+	//arc decreases with k, so binary search for the first element that starts at or before target:
+	size_t lo = 0, hi = size() - 1;
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		if (arc[mid] <= target) hi = mid;
+		else lo = mid + 1;
+	}
+	//distance from element lo's head-side end:
+	float into = std::min(float(arc[lo] + length[lo] - target), length[lo]);
+	into = std::max(into, 0.0f);
+	float t = into * inv_length[lo];
+	return glm::vec2(ax[lo] + t * dx[lo], ay[lo] + t * dy[lo]);
+}
+
+std::array< SegmentArrays, 2 > SnakeSim::BodySegments::runs() const {
+	//every ring sees the same pushes and pops, so they all split at the same place:
+	auto x = ax.spans(), y = ay.spans(), ddx = dx.spans(), ddy = dy.spans(), inv = inv_len2.spans();
+	std::array< SegmentArrays, 2 > ret;
+	for (uint32_t r = 0; r < 2; ++r) {
+		ret[r].ax = x[r].data;
+		ret[r].ay = y[r].data;
+		ret[r].dx = ddx[r].data;
+		ret[r].dy = ddy[r].data;
+		ret[r].inv_len2 = inv[r].data;
+		ret[r].count = x[r].size;
+	}
+	return ret;
+}
+
+void SnakeSim::push_head(size_t g, glm::vec2 const &vertex, float tolerance) {
+	RingBuffer< glm::vec2 > &snake_vertices = this->snake_vertices[g];
+	//vertex 1 can go if segment 1 is in the body (not the tail) and the head segment would join it without
+	// straying far from what it replaces (segment_distance2 also catches reversals, which a line test wouldn't):
+	if (tolerance >= 0.0f && snake_vertices.size() >= 4) {
+		glm::vec2 head = snake_vertices[0];
+		float error = neck_error[g] + std::sqrt(segment_distance2(snake_vertices[1], head, snake_vertices[2]));
+		if (error <= tolerance) {
+			body_grid[g].remove(head_serial[g] - 1, snake_vertices[1], snake_vertices[2]);
+			body_segments[g].pop_front();
+			body_cells[g].remove(snake_vertices[1], snake_vertices[2]);
+			snake_vertices.pop_front();
+			snake_vertices.pop_front();
+			snake_vertices.push_front(head);
+			head_serial[g] -= 1;
+			neck_error[g] = error;
+		} else {
+			neck_error[g] = 0.0f;
+		}
+	} else {
+		neck_error[g] = 0.0f;
+	}
+
+	snake_vertices.push_front(vertex);
+	head_serial[g] += 1;
+	//the old head segment is now segment 1 and won't move again (unless it is also the tail segment):
+	if (snake_vertices.size() >= 4) {
+		body_grid[g].insert(head_serial[g] - 1, snake_vertices[1], snake_vertices[2]);
+		body_segments[g].push_front(snake_vertices[1], snake_vertices[2]);
+		body_cells[g].add(snake_vertices[1], snake_vertices[2]);
+	} else if (snake_vertices.size() == 3) {
+		//the old head segment is the tail segment, so its length is tracked from here on:
+		tail_length[g] = veclength(snake_vertices[1] - snake_vertices[2]);
+	}
+}
+
+void SnakeSim::pop_tail(size_t g) {
+	RingBuffer< glm::vec2 > &snake_vertices = this->snake_vertices[g];
+	size_t n = snake_vertices.size();
+	//segment n-3 is about to become the (moving) tail segment:
+	if (n >= 4) {
+		body_grid[g].remove(head_serial[g] - uint32_t(n - 3), snake_vertices[n-3], snake_vertices[n-2]);
+		body_cells[g].remove(snake_vertices[n-3], snake_vertices[n-2]);
+		tail_length[g] = body_segments[g].length.back();
+		body_segments[g].pop_back();
+	}
+	snake_vertices.pop_back();
+}
+
+void SnakeSim::pop_head(size_t g) {
+	RingBuffer< glm::vec2 > &snake_vertices = this->snake_vertices[g];
+	//segment 1 is about to become the (moving) head segment:
+	if (snake_vertices.size() >= 4) {
+		body_grid[g].remove(head_serial[g] - 1, snake_vertices[1], snake_vertices[2]);
+		body_segments[g].pop_front();
+		body_cells[g].remove(snake_vertices[1], snake_vertices[2]);
+	}
+	snake_vertices.pop_front();
+	head_serial[g] -= 1;
+	neck_error[g] = 0.0f;
+}
+
+void SnakeSim::push_tail(size_t g, glm::vec2 const &vertex) {
+	RingBuffer< glm::vec2 > &snake_vertices = this->snake_vertices[g];
+	snake_vertices.push_back(vertex);
+	size_t n = snake_vertices.size();
+	//the old tail segment is now segment n-3 and won't move again (unless it is also the head segment):
+	if (n >= 4) {
+		body_grid[g].insert(head_serial[g] - uint32_t(n - 3), snake_vertices[n-3], snake_vertices[n-2]);
+		body_segments[g].push_back(snake_vertices[n-3], snake_vertices[n-2]);
+		body_cells[g].add(snake_vertices[n-3], snake_vertices[n-2]);
+	}
+	if (n >= 3) {
+		tail_length[g] = veclength(snake_vertices[n-2] - snake_vertices[n-1]);
+	}
+}
+
+float SnakeSim::tail_segment_length(size_t g) const {
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	size_t n = snake_vertices.size();
+	if (n < 2) return 0.0f;
+	//the head segment moves every update, so it is measured when asked:
+	if (n == 2) return veclength(snake_vertices[0] - snake_vertices[1]);
+	return tail_length[g];
+}
+
+void SnakeSim::move_tail(size_t g, float move_length) {
+	RingBuffer< glm::vec2 > &snake_vertices = this->snake_vertices[g];
+	float &length_update_buffer = this->length_update_buffer[g];
+
+	// Check if the length has increased first
+	if(move_length > length_update_buffer) {
+		move_length -= length_update_buffer;
+		length_update_buffer = 0.0f;
+
+		// trim end of snake
+		// (segment lengths were cached when the segments were made, so this doesn't measure anything)
+		while(true) {
+			glm::vec2 &end = snake_vertices.back();
+			glm::vec2 penult = snake_vertices[snake_vertices.size() - 2];
+			float length = tail_segment_length(g);
+
+			// if movement is larger than snake segment, remove it completely
+			if(move_length > length) {
+				move_length -= length;
+				pop_tail(g);
+			} else {
+				end += (penult - end) * move_length / length;
+				tail_length[g] = length - move_length;
+				break;
+			}
+		}
+	} else {
+		// can skip trimming snake
+		length_update_buffer -= move_length;
+	}
+}
+
+glm::vec2 SnakeSim::spawn_fruit(size_t g) {
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	size_t n = snake_vertices.size();
+	float const reach = snake_radius + fruit_radius;
+	//the head and tail segments move, so aren't in body_cells; a spot near them is re-drawn (a few times at most):
+	auto near_moving = [&](glm::vec2 const &pt) {
+		if (n >= 2 && segment_distance2(pt, snake_vertices[0], snake_vertices[1]) < reach * reach) return true;
+		if (n >= 3 && segment_distance2(pt, snake_vertices[n-2], snake_vertices[n-1]) < reach * reach) return true;
+		return false;
+	};
+	glm::vec2 at = body_cells[g].sample(rng[g]);
+	for (uint32_t attempt = 0; attempt < 4 && near_moving(at); ++attempt) {
+		at = body_cells[g].sample(rng[g]);
+	}
+	return at;
+}
+
+float SnakeSim::body_length(size_t g) const {
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	size_t n = snake_vertices.size();
+	if (n <= 2) return tail_segment_length(g);
+	return veclength(snake_vertices[0] - snake_vertices[1]) + body_segments[g].total_length() + tail_length[g];
+}
+
+glm::vec2 SnakeSim::point_along_body(size_t g, float distance) const {
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	size_t n = snake_vertices.size();
+	assert(n > 0);
+	if (n == 1) return snake_vertices[0];
+
+	auto along_segment = [](glm::vec2 const &a, glm::vec2 const &b, float length, float d) {
+		if (length <= 0.0f) return a;
+		return a + (b - a) * (std::min(std::max(d, 0.0f), length) / length);
+	};
+
+	//head segment:
+	float head_length = veclength(snake_vertices[0] - snake_vertices[1]);
+	if (distance <= head_length || n == 2) {
+		return along_segment(snake_vertices[0], snake_vertices[1], head_length, distance);
+	}
+	distance -= head_length;
+
+	//unmoving segments:
+	BodySegments const &body = body_segments[g];
+	float middle = body.total_length();
+	if (body.size() > 0 && distance <= middle) {
+		return body.point_along(distance);
+	}
+	distance -= middle;
+
+	//tail segment:
+	return along_segment(snake_vertices[n-2], snake_vertices[n-1], tail_length[g], distance);
+}
+
+bool SnakeSim::head_hits_body(size_t g) const {
+	if (body_segments[g].size() <= simd_body_limit) {
+		return head_hits_body_simd(g);
+	} else {
+		return head_hits_body_grid(g);
+	}
+}
+
+bool SnakeSim::head_hits_body_grid(size_t g) const {
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	size_t n = snake_vertices.size();
+	// we ignore the second snake segment for balance, so we can skip if there
+	// are less than 4 vertices
+	if (n <= 3) return false;
+
+	glm::vec2 head = snake_vertices[0];
+	float const diameter = 2.0f * snake_radius;
+
+	// collision if distance from head to segment is less than diameter
+	if (body_grid[g].any_near(head, diameter, [&](SegmentGrid::Entry const &e){
+		if (head_serial[g] - e.id < 2) return false; // skip second segment
+		return segment_distance2(head, e.a, e.b) < diameter * diameter;
+	})) {
+		return true;
+	}
+
+	//the tail segment moves every update, so it isn't in the grid:
+	return segment_distance2(head, snake_vertices[n-2], snake_vertices[n-1]) < diameter * diameter;
+}
+
+bool SnakeSim::head_hits_body_simd(size_t g) const {
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	size_t n = snake_vertices.size();
+	if (n <= 3) return false;
+
+	glm::vec2 head = snake_vertices[0];
+	float const diameter = 2.0f * snake_radius;
+
+	std::array< SegmentArrays, 2 > runs = body_segments[g].runs();
+	// skip second segment (element zero of body_segments):
+	if (runs[0].count > 0) {
+		runs[0].ax += 1;
+		runs[0].ay += 1;
+		runs[0].dx += 1;
+		runs[0].dy += 1;
+		runs[0].inv_len2 += 1;
+		runs[0].count -= 1;
+	}
+	for (auto const &run : runs) {
+		if (first_segment_within(run, head, diameter) < run.count) return true;
+	}
+
+	//the tail segment isn't in body_segments:
+	return segment_distance2(head, snake_vertices[n-2], snake_vertices[n-1]) < diameter * diameter;
+}
+
+bool SnakeSim::head_hits_body_scan(size_t g) const {
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	if (snake_vertices.size() <= 3) return false;
+
+	glm::vec2 head = snake_vertices[0];
+	float const diameter = 2.0f * snake_radius;
+
+	//walk the (up to two) contiguous runs of vertices, carrying the previous vertex across:
+	size_t index = 0;
+	glm::vec2 prev_vertex = head;
+	for (auto const &span : snake_vertices.spans()) {
+		for (glm::vec2 const &cur_vertex : span) {
+			if (index >= 3) { // skip second segment
+				if (segment_distance2(head, prev_vertex, cur_vertex) < diameter * diameter) {
+					return true;
+				}
+			}
+			prev_vertex = cur_vertex;
+			index += 1;
+		}
+	}
+	return false;
+}
+
+bool SnakeSim::sweep_box(glm::vec2 const &from, glm::vec2 const &step, glm::vec2 const &center, glm::vec2 const &half, float *t, uint32_t *axis) {
+	//quick rejection (the usual case): the step's bounding box doesn't reach the box:
+	glm::vec2 to = from + step;
+	if (std::min(from.x, to.x) > center.x + half.x || std::max(from.x, to.x) < center.x - half.x
+	 || std::min(from.y, to.y) > center.y + half.y || std::max(from.y, to.y) < center.y - half.y) {
+		return false;
+	}
+
+	//slab test: find when the point is inside the box's extent along each axis, and intersect those intervals:
+	float enter[2], exit[2];
+	for (uint32_t a = 0; a < 2; ++a) {
+		float lo = center[a] - half[a] - from[a];
+		float hi = center[a] + half[a] - from[a];
+		if (step[a] == 0.0f) {
+			if (lo > 0.0f || hi < 0.0f) return false;
+			enter[a] = -std::numeric_limits< float >::infinity();
+			exit[a] = std::numeric_limits< float >::infinity();
+		} else {
+			enter[a] = std::min(lo / step[a], hi / step[a]);
+			exit[a] = std::max(lo / step[a], hi / step[a]);
+		}
+	}
+	float t_enter = std::max(enter[0], enter[1]);
+	float t_exit = std::min(exit[0], exit[1]);
+	if (t_enter > t_exit || t_exit <= 0.0f || t_enter > 1.0f) return false;
+	*t = t_enter;
+	*axis = (enter[0] >= enter[1] ? 0 : 1);
+	return true;
+}
+
+bool SnakeSim::sweep_paddle(glm::vec2 const &from, glm::vec2 const &step, glm::vec2 const &paddle, float *t, bool *x_face) {
+	uint32_t axis;
+	if (!sweep_box(from, step, paddle, paddle_size + snake_size, t, &axis)) return false;
+	if (*t >= 0.0f) {
+		*x_face = (axis == 0);
+	} else {
+		//already overlapping (the paddle moved onto the head), so push out through the face with less overlap:
+		glm::vec2 min = glm::max(paddle - paddle_size, from - snake_size);
+		glm::vec2 max = glm::min(paddle + paddle_size, from + snake_size);
+		*x_face = !(max.x - min.x > max.y - min.y);
+		*t = 0.0f;
+	}
+	return true;
+}
+
+//when does a point moving from 'from' to 'from + step' first come within 'radius' of the segment from 'a' to 'b'?
+// returns the fraction of the step (zero if already within; greater than one if never):
+static float sweep_capsule(glm::vec2 const &from, glm::vec2 const &step, glm::vec2 const &a, glm::vec2 const &b, float radius) {
+	float const never = 2.0f;
+	//quick rejection: the step's bounding box doesn't reach the segment's (grown by radius):
+	glm::vec2 to = from + step;
+	if (std::min(from.x, to.x) > std::max(a.x, b.x) + radius || std::max(from.x, to.x) < std::min(a.x, b.x) - radius
+	 || std::min(from.y, to.y) > std::max(a.y, b.y) + radius || std::max(from.y, to.y) < std::min(a.y, b.y) - radius) {
+		return never;
+	}
+	if (segment_distance2(from, a, b) < radius * radius) return 0.0f;
+
+	float first = never;
+	//end caps: |from + t * step - c|^2 = radius^2
+	float ss = glm::dot(step, step);
+	if (ss == 0.0f) return never;
+	for (glm::vec2 const &c : {a, b}) {
+		glm::vec2 fc = from - c;
+		float half_b = glm::dot(fc, step);
+		float disc = half_b * half_b - ss * (glm::dot(fc, fc) - radius * radius);
+		if (disc < 0.0f) continue;
+		float t = (-half_b - std::sqrt(disc)) / ss;
+		if (t >= 0.0f) first = std::min(first, t);
+	}
+	//sides: in the segment's frame, when is |offset| < radius while the point is alongside the segment?
+	glm::vec2 ab = b - a;
+	float len = std::sqrt(glm::dot(ab, ab));
+	if (len > 0.0f) {
+		glm::vec2 along = ab / len;
+		glm::vec2 across = glm::vec2(-along.y, along.x);
+		float w0 = glm::dot(from - a, across), dw = glm::dot(step, across);
+		float u0 = glm::dot(from - a, along), du = glm::dot(step, along);
+		if (dw != 0.0f) {
+			//entering the band |w| < radius:
+			float t = (dw > 0.0f ? -radius - w0 : radius - w0) / dw;
+			float u = u0 + t * du;
+			if (t >= 0.0f && u >= 0.0f && u <= len) first = std::min(first, t);
+		}
+	}
+	return first;
+}
+
+float SnakeSim::time_to_event(size_t g) const {
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	glm::vec2 const head = snake_vertices[0];
+	glm::vec2 const velocity = head_speed(g) * snake_velocity[g];
+	float const inf = std::numeric_limits< float >::infinity();
+	if (velocity.x == 0.0f && velocity.y == 0.0f) return inf;
+
+	//the walls are the horizon -- the head always reaches one eventually:
+	glm::vec2 const wall = config.court_size - snake_size;
+	float horizon = inf;
+	for (uint32_t a = 0; a < 2; ++a) {
+		if (velocity[a] > 0.0f) horizon = std::min(horizon, (wall[a] - head[a]) / velocity[a]);
+		if (velocity[a] < 0.0f) horizon = std::min(horizon, (-wall[a] - head[a]) / velocity[a]);
+	}
+	horizon = std::max(horizon, 0.0f);
+	glm::vec2 const step = horizon * velocity;
+
+	//everything else, as a fraction of the way to the wall:
+	float first = 1.0f;
+	float t;
+	uint32_t axis;
+	bool x_face;
+	for (glm::vec2 const &paddle : {left_paddle[g], right_paddle[g]}) {
+		if (sweep_paddle(head, step, paddle, &t, &x_face)) first = std::min(first, std::max(t, 0.0f));
+	}
+	glm::vec2 const fruit_reach = glm::vec2(snake_radius + fruit_radius);
+	if (sweep_box(head, step, green_fruit[g], fruit_reach, &t, &axis)) first = std::min(first, std::max(t, 0.0f));
+	if (red_fruit_exists[g] && sweep_box(head, step, red_fruit[g], fruit_reach, &t, &axis)) first = std::min(first, std::max(t, 0.0f));
+
+	//the body (as in head_hits_body, segment 1 doesn't count; segments only shrink or vanish as the tail moves):
+	size_t n = snake_vertices.size();
+	if (n > 3) {
+		float const diameter = 2.0f * snake_radius;
+		BodySegments const &body = body_segments[g];
+		for (size_t k = 1; k < body.size(); ++k) {
+			glm::vec2 a = glm::vec2(body.ax[k], body.ay[k]);
+			first = std::min(first, sweep_capsule(head, step, a, a + glm::vec2(body.dx[k], body.dy[k]), diameter));
+		}
+		first = std::min(first, sweep_capsule(head, step, snake_vertices[n-2], snake_vertices[n-1], diameter));
+	}
+
+	return first * horizon;
+}
+
+uint32_t SnakeSim::fast_forward(size_t g, float tick, uint32_t max_ticks) {
+	if (!running[g] || max_ticks == 0) return 0;
+	assert(left_input[g] == 0);
+
+	//whole updates that finish before the event (with a little slack for rounding):
+	float until = time_to_event(g) - 1e-4f;
+	uint32_t straight = uint32_t(std::min(std::max(until / tick, 0.0f), float(max_ticks - 1)));
+
+	//if the head segment is also the tail segment, the tail chases the head -- which is only a straight
+	// line if the segment already points along the velocity (as it does unless the game was set up otherwise):
+	RingBuffer< glm::vec2 > const &snake_vertices = this->snake_vertices[g];
+	if (snake_vertices.size() == 2) {
+		glm::vec2 along = snake_vertices[0] - snake_vertices[1];
+		glm::vec2 const &v = snake_velocity[g];
+		if (std::abs(along.x * v.y - along.y * v.x) > 1e-5f * veclength(along) * veclength(v)) straight = 0;
+	}
+
+	//each of those updates would roll for a red fruit; make the same rolls (a few ns each), so the game's random
+	// stream -- and so every later fruit -- stays in step with running the updates one at a time:
+	bool spawn = false;
+	if (!red_fruit_exists[g]) {
+		for (uint32_t i = 0; i < straight; ++i) {
+			if (rng[g].uniform() < config.red_fruit_chance) {
+				straight = i + 1;
+				spawn = true;
+				break;
+			}
+		}
+	}
+
+	if (straight > 0) {
+		float elapsed = straight * tick;
+		glm::vec2 step = elapsed * head_speed(g) * snake_velocity[g];
+		this->snake_vertices[g][0] += step;
+		move_tail(g, veclength(step));
+		ticks[g] += straight;
+		time[g] += elapsed;
+	}
+	if (spawn) {
+		red_fruit[g] = spawn_fruit(g);
+		red_fruit_exists[g] = true;
+		return straight;
+	}
+
+	update(g, g + 1, tick);
+	return straight + 1;
+}
+
+void SnakeSim::update(size_t begin, size_t end, float elapsed) {
+	if (config.is_default()) {
+		update_with(begin, end, elapsed, DefaultConfig());
+	} else {
+		update_with(begin, end, elapsed, config);
+	}
+}
+
+template< typename Config >
+void SnakeSim::update_with(size_t begin, size_t end, float elapsed, Config const &constants) {
+	//----- paddles -----
+	//(straight-line code over the state arrays, so this pass vectorizes across games)
+	for (size_t g = begin; g < end; ++g) {
+		float step = running[g] ? paddle_step * left_input[g] : 0.0f;
+		left_paddle[g].y += step;
+
+		left_paddle[g].y = std::min(left_paddle[g].y, constants.court_size.y - paddle_size.y);
+		left_paddle[g].y = std::max(left_paddle[g].y, -constants.court_size.y + paddle_size.y);
+		right_paddle[g].y = std::min(right_paddle[g].y, constants.court_size.y - paddle_size.y);
+		right_paddle[g].y = std::max(right_paddle[g].y, -constants.court_size.y + paddle_size.y);
+	}
+
+	for (size_t g = begin; g < end; ++g) {
+		if (!running[g]) continue;
+
+		ticks[g] += 1;
+		time[g] += elapsed;
+
+		RingBuffer< glm::vec2 > &snake_vertices = this->snake_vertices[g];
+		glm::vec2 &snake_velocity = this->snake_velocity[g];
+		float &length_update_buffer = this->length_update_buffer[g];
+
+		//----- snake head update -----
+
+		// speed of snake scales proportionally with snake length (capped for balance reasons)
+		float speed_multiplier = head_speed(g);
+
+		float move_length = veclength(elapsed * speed_multiplier * snake_velocity);
+
+		//---- collision handling ----
+
+		//the head moves along its velocity, bouncing off paddles and walls at the moment it touches them
+		// (swept, so fast snakes and long updates can't pass through anything);
+		// path[0..path_size) are the points the head went through this update:
+		std::array< glm::vec2, max_bounces + 2 > path;
+		uint32_t path_size = 0;
+		glm::vec2 from = snake_vertices[0];
+		path[path_size++] = from;
+		float remaining = 1.0f; //fraction of the update left to move through
+
+		glm::vec2 const paddle_reach = paddle_size + snake_size;
+		glm::vec2 const wall = constants.court_size - snake_size;
+
+		for (uint32_t bounce = 0; ; ++bounce) {
+			glm::vec2 step = remaining * elapsed * speed_multiplier * snake_velocity;
+
+			//find the first thing the head touches:
+			enum { None, LeftPaddle, RightPaddle, TopWall, BottomWall, RightWall, LeftWall } hit = None;
+			float hit_t = 2.0f;
+			bool x_face = false;
+
+			float t;
+			bool paddle_x_face;
+			if (sweep_paddle(from, step, left_paddle[g], &t, &paddle_x_face) && t < hit_t) {
+				hit = LeftPaddle; hit_t = t; x_face = paddle_x_face;
+			}
+			if (sweep_paddle(from, step, right_paddle[g], &t, &paddle_x_face) && t < hit_t) {
+				hit = RightPaddle; hit_t = t; x_face = paddle_x_face;
+			}
+			if (step.y > 0.0f && from.y + step.y > wall.y) {
+				t = std::max(0.0f, (wall.y - from.y) / step.y);
+				if (t < hit_t) { hit = TopWall; hit_t = t; }
+			} else if (step.y < 0.0f && from.y + step.y < -wall.y) {
+				t = std::max(0.0f, (-wall.y - from.y) / step.y);
+				if (t < hit_t) { hit = BottomWall; hit_t = t; }
+			}
+			if (step.x > 0.0f && from.x + step.x > wall.x) {
+				t = std::max(0.0f, (wall.x - from.x) / step.x);
+				if (t < hit_t) { hit = RightWall; hit_t = t; }
+			} else if (step.x < 0.0f && from.x + step.x < -wall.x) {
+				t = std::max(0.0f, (-wall.x - from.x) / step.x);
+				if (t < hit_t) { hit = LeftWall; hit_t = t; }
+			}
+
+			if (hit == None || bounce == max_bounces) {
+				//(if it is somehow still bouncing after max_bounces, the head stops where it is)
+				if (hit == None) from += step;
+				snake_vertices[0] = from;
+				path[path_size++] = from;
+				break;
+			}
+
+			//move to the point of contact and leave a vertex there:
+			glm::vec2 contact = from + hit_t * step;
+
+			if (hit == LeftPaddle || hit == RightPaddle) {
+				glm::vec2 const &paddle = (hit == LeftPaddle ? left_paddle[g] : right_paddle[g]);
+				if (!x_face) {
+					//top or bottom face => bounce in y direction:
+					if (contact.y > paddle.y) {
+						contact.y = paddle.y + paddle_reach.y;
+						snake_velocity.y = std::abs(snake_velocity.y);
+					} else {
+						contact.y = paddle.y - paddle_reach.y;
+						snake_velocity.y = -std::abs(snake_velocity.y);
+					}
+				} else {
+					//side face => bounce in x direction:
+					if (contact.x > paddle.x) {
+						contact.x = paddle.x + paddle_reach.x;
+						snake_velocity.x = std::abs(snake_velocity.x);
+					} else {
+						contact.x = paddle.x - paddle_reach.x;
+						snake_velocity.x = -std::abs(snake_velocity.x);
+					}
+					//warp y velocity based on offset from paddle center:
+					float vel = (contact.y - paddle.y) / paddle_reach.y;
+					snake_velocity.y = glm::mix(snake_velocity.y, vel, 0.75f);
+				}
+			} else if (hit == TopWall) {
+				contact.y = wall.y;
+				snake_velocity.y = -std::abs(snake_velocity.y);
+			} else if (hit == BottomWall) {
+				contact.y = -wall.y;
+				snake_velocity.y = std::abs(snake_velocity.y);
+			} else if (hit == RightWall) {
+				damaged(g, constants.paddle_miss_damage);
+				paddle_misses[g] += 1;
+				contact.x = wall.x;
+				snake_velocity.x = -std::abs(snake_velocity.x);
+			} else if (hit == LeftWall) {
+				damaged(g, constants.paddle_miss_damage);
+				paddle_misses[g] += 1;
+				contact.x = -wall.x;
+				snake_velocity.x = std::abs(snake_velocity.x);
+			}
+
+			snake_vertices[0] = contact;
+			push_head(g, contact, constants.simplify_tolerance);
+			path[path_size++] = contact;
+
+			from = contact;
+			remaining *= 1.0f - hit_t;
+		}
+
+		//----- snake tail update -----
+		move_tail(g, move_length);
+
+		//fruit is eaten if the head passed over it at any point during the update:
+		auto path_hits_fruit = [&](glm::vec2 const &fruit) {
+			glm::vec2 reach = glm::vec2(snake_radius + fruit_radius);
+			for (uint32_t i = 0; i + 1 < path_size; ++i) {
+				float t;
+				uint32_t axis;
+				if (sweep_box(path[i], path[i+1] - path[i], fruit, reach, &t, &axis)) return true;
+			}
+			return false;
+		};
+
+		// green fruit
+		if(path_hits_fruit(green_fruit[g])) {
+			// regenerate green_fruit someplace else
+			green_fruit[g] = spawn_fruit(g);
+
+			// increase snake length
+			length_update_buffer += constants.green_fruit_length_increase;
+			snake_length[g] += constants.green_fruit_length_increase;
+			green_fruit_eaten[g] += 1;
+		}
+
+		// red fruit
+		if(red_fruit_exists[g]) {
+			if(path_hits_fruit(red_fruit[g])) {
+				// heal
+				damaged(g, -red_fruit_heal);
+				red_fruit_heals[g] += 1;
+
+				red_fruit_exists[g] = false;
+			}
+		} else {
+			// otherwise spawn a red fruit with a chance
+			if(rng[g].uniform() < constants.red_fruit_chance) {
+				red_fruit[g] = spawn_fruit(g);
+				red_fruit_exists[g] = true;
+			}
+		}
+
+		// snake head with body
+		if(head_hits_body(g)) {
+			if(!last_collided[g]) {
+				damaged(g, constants.collision_damage);
+				body_hits[g] += 1;
+			}
+			last_collided[g] = true;
+		} else {
+			last_collided[g] = false;
+		}
+	}
+}
+
+//the two versions of update_with that update picks between:
+template void SnakeSim::update_with< DefaultConfig >(size_t, size_t, float, DefaultConfig const &);
+template void SnakeSim::update_with< SnakeConfig >(size_t, size_t, float, SnakeConfig const &);
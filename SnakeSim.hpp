@@ -0,0 +1,203 @@
+#pragma once
+
+#include "SnakeConfig.hpp"
+#include "SegmentGrid.hpp"
+#include "OccupancyGrid.hpp"
+#include "CounterRng.hpp"
+#include "RingBuffer.hpp"
+#include "segments_within.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+
+/*
+ * SnakeSim is the game logic behind PongMode with no dependency on SDL or OpenGL.
+ * It steps any number of independent games at once; game state is stored as
+ * a structure-of-arrays, with one vector per field indexed by game.
+ */
+
+struct SnakeSim {
+	SnakeSim(size_t count = 0, uint32_t seed = 0, SnakeConfig const &config = SnakeConfig());
+
+	//tuning constants shared by all games (set before adding games -- body_grid is sized to court_size):
+	SnakeConfig config;
+
+	//number of games:
+	size_t size() const { return running.size(); }
+
+	//adds 'count' games (each seeded with 'seed' + game index) and returns the index of the first one:
+	size_t add_games(size_t count, uint32_t seed = 0);
+
+	//(re)starts game 'g':
+	void setup(size_t g);
+	//replaces game g's snake with a straight one (of length snake_length) with its head at 'head', moving along 'direction':
+	void place(size_t g, glm::vec2 const &head, glm::vec2 const &direction);
+	//applies 'damage' to game 'g' (negative damage heals):
+	void damaged(size_t g, int damage);
+
+	//advances every running game by 'elapsed' seconds:
+	void update(float elapsed) { update(0, size(), elapsed); }
+	//advances running games in [begin, end) by 'elapsed' seconds:
+	void update(size_t begin, size_t end, float elapsed);
+	//...using tuning constants from 'constants', which is either 'config' or DefaultConfig
+	// (update picks DefaultConfig when config.is_default(), so the compiler can fold the constants in):
+	template< typename Config >
+	void update_with(size_t begin, size_t end, float elapsed, Config const &constants);
+
+	//----- event-driven fast-forward (for headless runs) -----
+	//Between events the head moves in a straight line at a constant speed, so whole runs of updates can be
+	// skipped over at once. This makes the same random draws as calling update each tick, but positions are
+	// summed differently, so results agree up to rounding (which can matter in near-tie bounces).
+
+	//seconds until game g's head first touches a wall, paddle, fruit, or its body if paddles are held still
+	// (infinity if the head isn't moving; zero if it is touching something now):
+	float time_to_event(size_t g) const;
+	//advances game g by up to 'max_ticks' updates of 'tick' seconds: moves straight through the updates before
+	// the next event (or red fruit spawn) and then runs update on the one with the event; returns updates advanced.
+	//Paddles must be held still (left_input zero, right_paddle unchanged) during the call.
+	uint32_t fast_forward(size_t g, float tick, uint32_t max_ticks);
+
+	//how fast game g's head moves (units per second, along snake_velocity):
+	float head_speed(size_t g) const { return std::min(2.0f + 0.5f * snake_length[g], max_speed); }
+
+	//snake body edits go through these so body_grid, body_segments, and tail_length stay in sync:
+	//(if 'tolerance' isn't negative, push_head first drops vertex 1 when the body would stay within 'tolerance'
+	// of every vertex dropped since segment 1 was made -- so collinear and zero-length segments don't pile up)
+	void push_head(size_t g, glm::vec2 const &vertex, float tolerance = -1.0f);
+	void pop_tail(size_t g);
+	//...and their inverses (for putting back an earlier state of the snake -- see Rollback):
+	void pop_head(size_t g);
+	void push_tail(size_t g, glm::vec2 const &vertex);
+	//trims 'move_length' from the tail, less whatever growth is waiting in length_update_buffer:
+	void move_tail(size_t g, float move_length);
+
+	//length of game g's snake as currently drawn (from cached segment lengths; one sqrt, for the head segment):
+	float body_length(size_t g) const;
+	//point 'distance' along game g's snake from the head (clamped to the tail), in O(log n):
+	glm::vec2 point_along_body(size_t g, float distance) const;
+	//length of the tail segment (vertices n-2 to n-1):
+	float tail_segment_length(size_t g) const;
+
+	//a random spot for fruit in game g, clear of the snake (in O(1), using body_cells):
+	glm::vec2 spawn_fruit(size_t g);
+
+	//hash of game g's state (for checking that replays and other re-runs come out the same):
+	uint64_t checksum(size_t g) const;
+
+	//is game g's head within a snake diameter of its body (ignoring the segment behind the head)?
+	bool head_hits_body(size_t g) const; //picks whichever of the following is faster for the snake's length
+	bool head_hits_body_grid(size_t g) const; //looks up nearby segments in body_grid
+	bool head_hits_body_simd(size_t g) const; //runs first_segment_within over body_segments
+	bool head_hits_body_scan(size_t g) const; //checks every segment, one at a time (reference for the others)
+
+	//bodies with at most this many unmoving segments are checked with head_hits_body_simd:
+	static constexpr size_t simd_body_limit = 32;
+
+	//continuous collision: when does a point moving from 'from' to 'from + step' first touch the box 'center' +/- 'half'?
+	// returns false if it doesn't touch it during the step; otherwise sets 't' (in [0,1], or negative if 'from' is
+	// already inside) and 'axis' (0 if it comes in through a side face, 1 for top or bottom)
+	static bool sweep_box(glm::vec2 const &from, glm::vec2 const &step, glm::vec2 const &center, glm::vec2 const &half, float *t, uint32_t *axis);
+	//...the same for the head vs a paddle ('t' is zero if the paddle has moved onto the head):
+	static bool sweep_paddle(glm::vec2 const &from, glm::vec2 const &step, glm::vec2 const &paddle, float *t, bool *x_face);
+	//most paddle and wall bounces handled in one update:
+	static constexpr uint32_t max_bounces = 8;
+
+	// game constants (the tunable ones are in 'config')
+	static constexpr glm::vec2 paddle_size = glm::vec2(0.2f, 1.0f);
+
+	static constexpr float snake_radius = 0.2f;
+	static constexpr glm::vec2 snake_size = glm::vec2(snake_radius,
+			snake_radius);
+
+	static constexpr float fruit_radius = 0.3f;
+	static constexpr glm::vec2 fruit_size = glm::vec2(fruit_radius,
+			fruit_radius);
+
+	static constexpr int red_fruit_heal = 1;
+
+	static constexpr float paddle_step = 0.2f; //left paddle movement per update
+	static constexpr float max_speed = 7.5f; //snake speed cap
+
+	//----- inputs, one per game -----
+
+	//left paddle direction for the next update: +1 up, -1 down, 0 hold (the W/S keys):
+	std::vector< int8_t > left_input;
+	//right_paddle is positioned directly (by the mouse, in PongMode).
+
+	//----- game state, one per game -----
+	std::vector< uint8_t > running;
+
+	std::vector< glm::vec2 > left_paddle;
+	std::vector< glm::vec2 > right_paddle;
+
+	std::vector< glm::vec2 > snake_velocity;
+
+	std::vector< float > snake_length;
+	std::vector< RingBuffer< glm::vec2 > > snake_vertices;
+
+	//snake_vertices[g][i] has serial number head_serial[g] - i;
+	// segment i (from vertex i to vertex i+1) is identified by the serial of vertex i:
+	std::vector< uint32_t > head_serial;
+	//the segments that never move -- all but the head and tail segments -- bucketed by location:
+	std::vector< SegmentGrid > body_grid;
+
+	//...and the same segments as a structure-of-arrays ring (element k is segment k+1),
+	// with everything about each segment computed once, when the segment stops moving:
+	struct BodySegments {
+		RingBuffer< float > ax, ay, dx, dy, inv_len2; //head-side vertex, vector toward the tail, 1/length^2
+		RingBuffer< float > length, inv_length;
+		//arc[k] is the distance along the body to the tail-side end of element k, measured from
+		// wherever the body started (so values don't change as segments come and go);
+		// element k covers arc lengths [arc[k], arc[k] + length[k]]:
+		RingBuffer< double > arc;
+		double arc_total = 0.0; //arc length of the head-side end of element zero
+
+		size_t size() const { return ax.size(); }
+		void clear();
+		void push_front(glm::vec2 const &a, glm::vec2 const &b);
+		void push_back(glm::vec2 const &a, glm::vec2 const &b);
+		void pop_front();
+		void pop_back();
+		//total length of elements [0, size()):
+		float total_length() const { return arc.empty() ? 0.0f : float(arc_total - arc.back()); }
+		//point at distance 'along' from the head-side end of element zero (clamped to the body):
+		glm::vec2 point_along(float along) const;
+		//elements [0, size()) as (up to) two runs of contiguous arrays:
+		std::array< SegmentArrays, 2 > runs() const;
+	};
+	std::vector< BodySegments > body_segments;
+	//...and the cells of the fruit spawning area that those segments leave clear:
+	std::vector< OccupancyGrid > body_cells;
+
+	//the tail segment's length, updated as it is trimmed (not used while the tail segment is the head segment):
+	std::vector< float > tail_length;
+
+	//how far segment 1 may be from vertices that push_head merged away (zero if none were):
+	std::vector< float > neck_error;
+
+	std::vector< glm::vec2 > green_fruit;
+	std::vector< uint8_t > red_fruit_exists;
+	std::vector< glm::vec2 > red_fruit;
+
+	std::vector< float > length_update_buffer;
+
+	// flag to prevent multiple collisions along the same segment
+	std::vector< uint8_t > last_collided;
+
+	std::vector< int > health;
+
+	//each game draws from its own random stream (keyed by the game's seed):
+	std::vector< CounterRng > rng;
+
+	//----- statistics, one per game (reset by setup) -----
+	std::vector< uint32_t > ticks; //updates while running
+	std::vector< float > time; //seconds while running
+	std::vector< uint32_t > paddle_misses; //times the head reached the left or right wall
+	std::vector< uint32_t > body_hits; //times the head ran into the body (and took damage)
+	std::vector< uint32_t > green_fruit_eaten;
+	std::vector< uint32_t > red_fruit_heals;
+};
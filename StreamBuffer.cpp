@@ -0,0 +1,44 @@
+#include "StreamBuffer.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+StreamBuffer::StreamBuffer(GLenum target_, GLenum usage_) : target(target_), usage(usage_) {
+	glGenBuffers(1, &buffer);
+}
+
+StreamBuffer::~StreamBuffer() {
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+void StreamBuffer::upload(void const *data, size_t size) {
+	glBindBuffer(target, buffer);
+	if (size > capacity) {
+		//grow geometrically, so a slowly growing upload only reallocates now and then:
+		capacity = std::max(size, 2 * capacity);
+		counts.reallocations += 1;
+	}
+	//(same size as before when it didn't grow, so the driver can recycle the storage)
+	glBufferData(target, capacity, nullptr, usage);
+	if (size) glBufferSubData(target, 0, size, data);
+	counts.bytes += size;
+	counts.uploads += 1;
+}
+
+bool StreamBuffer::reserve(size_t size) {
+	if (size <= capacity) return false;
+	capacity = std::max(size, 2 * capacity);
+	counts.reallocations += 1;
+	glBindBuffer(target, buffer);
+	glBufferData(target, capacity, nullptr, usage);
+	return true;
+}
+
+void StreamBuffer::update(size_t offset, void const *data, size_t size) {
+	assert(offset + size <= capacity);
+	glBindBuffer(target, buffer);
+	if (size) glBufferSubData(target, offset, size, data);
+	counts.bytes += size;
+	counts.uploads += 1;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "GL.hpp"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * StreamBuffer is an OpenGL buffer for data that is uploaded again and again
+ * (e.g., vertices rebuilt every frame).
+ *
+ * Its storage is reallocated only when an upload doesn't fit, and then grows to
+ * at least twice its old size, so uploads of about the same size every frame
+ * soon settle into reusing the same storage.
+ *
+ * Each upload orphans the old contents (glBufferData of the same size with no
+ * data -- the driver can hand back fresh memory rather than wait for draws that
+ * still read the old contents) and then fills in the new ones with glBufferSubData.
+ *
+ * Data that mostly stays put can instead be kept between frames: reserve storage
+ * once, then overwrite just the parts that changed with update (which doesn't orphan).
+ *
+ * The buffer name never changes, so vertex array objects set up with it stay valid.
+ */
+
+struct StreamBuffer {
+	StreamBuffer(GLenum target = GL_ARRAY_BUFFER, GLenum usage = GL_STREAM_DRAW);
+	~StreamBuffer();
+	StreamBuffer(StreamBuffer const &) = delete;
+	StreamBuffer &operator=(StreamBuffer const &) = delete;
+
+	GLenum target;
+	GLenum usage;
+	GLuint buffer = 0;
+	size_t capacity = 0; //bytes of storage
+
+	//replaces the contents with 'size' bytes from 'data'
+	// (binds the buffer to 'target' and leaves it bound):
+	void upload(void const *data, size_t size);
+	template< typename T >
+	void upload(std::vector< T > const &data) { upload(data.data(), data.size() * sizeof(T)); }
+
+	//makes sure storage holds at least 'size' bytes (growing as upload does), for use with update:
+	// returns true if the storage was reallocated (which loses the old contents)
+	bool reserve(size_t size);
+	//overwrites bytes ['offset', 'offset' + 'size') with 'data', leaving the rest as it was
+	// (must fit in capacity; binds the buffer to 'target' and leaves it bound):
+	void update(size_t offset, void const *data, size_t size);
+
+	//what upload and update have done since 'counts' was last reset (e.g., at the start of a frame):
+	struct Counts {
+		uint64_t bytes = 0; //uploaded
+		uint32_t uploads = 0; //(calls to upload or update)
+		uint32_t reallocations = 0; //times the storage had to grow
+	} counts;
+};
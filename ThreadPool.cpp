@@ -0,0 +1,123 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t count) {
+	if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+	queues.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		queues.emplace_back(new Queue);
+	}
+	threads.reserve(count - 1);
+	for (size_t worker = 1; worker < count; ++worker) {
+		threads.emplace_back(&ThreadPool::thread_main, this, worker);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard< std::mutex > lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
+
+void ThreadPool::parallel_for(size_t count, std::function< void(size_t, size_t) > const &fn) {
+	if (count == 0) return;
+
+	//hand each thread an equal slice:
+	for (size_t q = 0; q < queues.size(); ++q) {
+		std::lock_guard< std::mutex > lock(queues[q]->mutex);
+		queues[q]->begin = count * q / queues.size();
+		queues[q]->end = count * (q + 1) / queues.size();
+	}
+
+	{
+		std::lock_guard< std::mutex > lock(mutex);
+		job = &fn;
+		busy = threads.size();
+		generation += 1;
+		error = nullptr;
+	}
+	wake.notify_all();
+
+	work(0, fn);
+
+	std::exception_ptr failed;
+	{
+		std::unique_lock< std::mutex > lock(mutex);
+		done.wait(lock, [this](){ return busy == 0; });
+		job = nullptr;
+		failed = error;
+		error = nullptr;
+	}
+	if (failed) std::rethrow_exception(failed);
+}
+
+void ThreadPool::thread_main(size_t worker) {
+	uint64_t seen = 0;
+	while (true) {
+		std::function< void(size_t, size_t) > const *fn;
+		{
+			std::unique_lock< std::mutex > lock(mutex);
+			wake.wait(lock, [&](){ return quit || generation != seen; });
+			if (quit) return;
+			seen = generation;
+			fn = job;
+		}
+
+		work(worker, *fn);
+
+		{
+			std::lock_guard< std::mutex > lock(mutex);
+			busy -= 1;
+			if (busy == 0) done.notify_all();
+		}
+	}
+}
+
+void ThreadPool::work(size_t worker, std::function< void(size_t, size_t) > const &fn) {
+	size_t index;
+	while (take(worker, &index)) {
+		try {
+			fn(index, worker);
+		} catch (...) {
+			std::lock_guard< std::mutex > lock(mutex);
+			if (!error) error = std::current_exception();
+		}
+	}
+}
+
+bool ThreadPool::take(size_t worker, size_t *index) {
+	Queue &own = *queues[worker];
+	{ //own items first:
+		std::lock_guard< std::mutex > lock(own.mutex);
+		if (own.begin < own.end) {
+			*index = own.begin++;
+			return true;
+		}
+	}
+
+	//then steal the back half of someone else's range (starting with the next thread over, to spread out thieves):
+	for (size_t i = 1; i < queues.size(); ++i) {
+		Queue &victim = *queues[(worker + i) % queues.size()];
+		size_t begin, end;
+		{
+			std::lock_guard< std::mutex > lock(victim.mutex);
+			if (victim.begin >= victim.end) continue;
+			end = victim.end;
+			begin = victim.begin + (victim.end - victim.begin) / 2;
+			victim.end = begin;
+		}
+		//(only this thread adds to its own queue, and it's empty, so no items can be lost here)
+		std::lock_guard< std::mutex > lock(own.mutex);
+		own.begin = begin + 1;
+		own.end = end;
+		*index = begin;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * ThreadPool runs loops of independent work items on a fixed set of threads.
+ *
+ * parallel_for splits [0, count) evenly between the threads (the calling thread
+ * takes part as worker zero). Each thread works from the front of its own range;
+ * a thread that runs out steals the back half of another thread's range, so
+ * uneven items (e.g., games that end early) still keep every core busy.
+ *
+ * Threads sleep between calls and are reused, so a pool is cheap to call often.
+ */
+
+struct ThreadPool {
+	//'threads' is the total number of threads, including the caller (zero means one per core):
+	explicit ThreadPool(size_t threads = 0);
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const &) = delete;
+	ThreadPool &operator=(ThreadPool const &) = delete;
+
+	//number of threads (including the caller):
+	size_t size() const { return queues.size(); }
+
+	//calls fn(index, worker) for every index in [0, count) and returns when all calls are done;
+	// 'worker' is in [0, size()) and is never used by two calls at once, so it can pick per-thread scratch space.
+	//If any call throws, the first exception is rethrown here (after the other items finish).
+	//NOTE: fn must not call parallel_for on the same pool.
+	void parallel_for(size_t count, std::function< void(size_t index, size_t worker) > const &fn);
+
+	//----- internals -----
+	//each thread's remaining items, [begin, end):
+	struct Queue {
+		std::mutex mutex;
+		size_t begin = 0;
+		size_t end = 0;
+	};
+	std::vector< std::unique_ptr< Queue > > queues;
+	std::vector< std::thread > threads; //workers 1 .. size()-1
+
+	std::mutex mutex; //guards everything below
+	std::condition_variable wake; //signalled when a new job starts (or on quit)
+	std::condition_variable done; //signalled when the last worker finishes a job
+	std::function< void(size_t, size_t) > const *job = nullptr;
+	uint64_t generation = 0; //counts jobs, so sleeping workers can tell a new one started
+	size_t busy = 0; //workers (not counting the caller) still running the current job
+	std::exception_ptr error;
+	bool quit = false;
+
+	void thread_main(size_t worker);
+	//runs items (own, then stolen) until there are none left to find:
+	void work(size_t worker, std::function< void(size_t, size_t) > const &fn);
+	//takes the next item for 'worker', stealing if needed:
+	bool take(size_t worker, size_t *index);
+};
@@ -0,0 +1,1008 @@
+//bench runs micro-benchmarks of the game logic (no SDL, no OpenGL).
+// usage: bench [name ...]
+//  (with no names, runs every benchmark)
+
+#include "SnakeSim.hpp"
+#include "ArenaSim.hpp"
+#include "PaddleBot.hpp"
+#include "Rollback.hpp"
+#include "ThreadPool.hpp"
+#include "RingBuffer.hpp"
+#include "segments_within.hpp"
+#include "segment_quads.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+//runs 'fn' (which performs 'count' operations) enough times to take a little while, and returns nanoseconds per operation:
+static double time_per_op(size_t count, std::function< void() > const &fn) {
+	double best = 1e30;
+	for (int trial = 0; trial < 5; ++trial) {
+		auto before = std::chrono::high_resolution_clock::now();
+		fn();
+		auto after = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration< double, std::nano >(after - before).count() / count);
+	}
+	return best;
+}
+
+//keeps the optimizer from discarding benchmark results:
+static volatile size_t sink = 0;
+
+//count heap allocations, to check for steady-state allocation:
+static size_t allocations = 0;
+void *operator new(size_t size) {
+	allocations += 1;
+	if (void *ret = std::malloc(size)) return ret;
+	throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+//replaces game g's snake with 'vertices' (head first), going through push_head so the body_grid and body_segments are filled:
+static void set_snake(SnakeSim &sim, size_t g, std::vector< glm::vec2 > const &vertices) {
+	sim.snake_vertices[g].clear();
+	sim.body_grid[g].clear();
+	sim.body_segments[g].clear();
+	sim.body_cells[g].clear();
+	sim.head_serial[g] = 0;
+	sim.neck_error[g] = 0.0f;
+	sim.snake_vertices[g].emplace_back(vertices.back());
+	for (size_t i = vertices.size() - 1; i > 0; --i) {
+		sim.push_head(g, vertices[i-1]);
+	}
+}
+
+//a snake of 'count' segments, each 'step' long, wandering around the court:
+static std::vector< glm::vec2 > wandering_snake(size_t count, float step, std::mt19937 &mt, glm::vec2 const &start = glm::vec2(0.0f), glm::vec2 const &court_size = DefaultConfig::court_size) {
+	glm::vec2 limit = court_size - SnakeSim::snake_size;
+	std::uniform_real_distribution< float > turn(-0.6f, 0.6f);
+	std::vector< glm::vec2 > vertices;
+	glm::vec2 at = start;
+	float angle = 0.0f;
+	vertices.emplace_back(at);
+	while (vertices.size() <= count) {
+		angle += turn(mt);
+		glm::vec2 next = at + step * glm::vec2(std::cos(angle), std::sin(angle));
+		//bounce off the walls:
+		if (next.x < -limit.x || next.x > limit.x) {
+			angle = 3.14159265f - angle;
+			continue;
+		}
+		if (next.y < -limit.y || next.y > limit.y) {
+			angle = -angle;
+			continue;
+		}
+		at = next;
+		vertices.emplace_back(at);
+	}
+	return vertices;
+}
+
+static void bench_body_grid() {
+	std::cout << "--- head-vs-body collision: body_grid vs full scan ---\n";
+	std::cout << "(snake made of 0.5-long segments; queries are at points that do not collide, so the scan can't stop early)\n";
+	std::cout << "(ns per query; 'used' is head_hits_body, which picks simd or grid by length;\n"
+		"  'near' is the grid entries a query looks at -- the court is a fixed size, so longer snakes crowd its cells,\n"
+		"  and grid cost follows 'near' rather than staying flat)\n";
+	std::cout << std::setw(10) << "segments" << std::setw(10) << "scan" << std::setw(10) << "simd" << std::setw(10) << "grid" << std::setw(10) << "used"
+		<< std::setw(8) << "near" << std::setw(12) << "mismatches" << "\n";
+
+	std::mt19937 mt(0x5eed);
+	std::uniform_real_distribution< float > ux(-DefaultConfig::court_size.x, DefaultConfig::court_size.x);
+	std::uniform_real_distribution< float > uy(-DefaultConfig::court_size.y, DefaultConfig::court_size.y);
+
+	for (size_t segments = 16; segments <= 4096; segments *= 2) {
+		SnakeSim sim(1);
+		set_snake(sim, 0, wandering_snake(segments, 0.5f, mt));
+
+		size_t mismatches = 0;
+		std::vector< glm::vec2 > heads;
+		for (uint32_t attempt = 0; attempt < 100000 && heads.size() < 1024; ++attempt) {
+			glm::vec2 h = glm::vec2(ux(mt), uy(mt));
+			sim.snake_vertices[0][0] = h;
+			bool scan_hit = sim.head_hits_body_scan(0);
+			if (sim.head_hits_body_grid(0) != scan_hit) mismatches += 1;
+			if (sim.head_hits_body_simd(0) != scan_hit) mismatches += 1;
+			if (!scan_hit) heads.emplace_back(h);
+		}
+		if (heads.empty()) {
+			std::cout << std::setw(10) << segments << "  (court is full; no collision-free query points)\n";
+			continue;
+		}
+
+		auto time_queries = [&](bool (SnakeSim::*query)(size_t) const) {
+			return time_per_op(heads.size(), [&](){
+				size_t hits = 0;
+				for (auto const &h : heads) {
+					sim.snake_vertices[0][0] = h;
+					hits += (sim.*query)(0);
+				}
+				sink += hits;
+			});
+		};
+		double scan = time_queries(&SnakeSim::head_hits_body_scan);
+		double simd = time_queries(&SnakeSim::head_hits_body_simd);
+		double grid = time_queries(&SnakeSim::head_hits_body_grid);
+		double used = time_queries(&SnakeSim::head_hits_body);
+
+		size_t near = 0;
+		for (auto const &h : heads) {
+			sim.body_grid[0].any_near(h, 2.0f * SnakeSim::snake_radius, [&near](SegmentGrid::Entry const &) {
+				near += 1;
+				return false;
+			});
+		}
+
+		std::cout << std::setw(10) << segments << std::fixed << std::setprecision(1)
+			<< std::setw(10) << scan << std::setw(10) << simd << std::setw(10) << grid << std::setw(10) << used
+			<< std::setw(8) << double(near) / heads.size() << std::setw(12) << mismatches << "\n";
+	}
+
+	//check that grid bookkeeping matches a full scan over real games, too:
+	SnakeSim sim(64);
+	size_t mismatches = 0, checks = 0;
+	for (int tick = 0; tick < 20000; ++tick) {
+		for (size_t g = 0; g < sim.size(); ++g) {
+			if (!sim.running[g]) sim.setup(g);
+			glm::vec2 head = sim.snake_vertices[g][0];
+			sim.left_input[g] = (head.y > sim.left_paddle[g].y ? 1 : -1);
+			sim.right_paddle[g].y = head.y;
+			//grow the snake quickly so bodies get long:
+			if (tick % 60 == 0) {
+				sim.snake_length[g] += 2.0f;
+				sim.length_update_buffer[g] += 2.0f;
+			}
+			bool scan_hit = sim.head_hits_body_scan(g);
+			mismatches += (sim.head_hits_body_grid(g) != scan_hit);
+			mismatches += (sim.head_hits_body_simd(g) != scan_hit);
+			checks += 2;
+		}
+		sim.update(1.0f / 60.0f);
+	}
+	std::cout << "in-game agreement: " << (checks - mismatches) << " / " << checks << " checks match" << std::endl;
+}
+
+static void bench_ring_buffer() {
+	std::cout << "--- snake vertex storage: RingBuffer vs std::deque ---\n";
+	std::cout << "(churn = push_front + pop_back at steady size, per op; walk = summing every squared segment length, per vertex)\n";
+	std::cout << std::setw(10) << "vertices" << std::setw(16) << "deque churn ns" << std::setw(15) << "ring churn ns"
+		<< std::setw(15) << "deque walk ns" << std::setw(14) << "ring walk ns"
+		<< std::setw(14) << "deque allocs" << std::setw(13) << "ring allocs" << "\n";
+
+	std::mt19937 mt(0x5eed);
+	for (size_t n = 1000; n <= 1000000; n *= 10) {
+		std::vector< glm::vec2 > points = wandering_snake(n - 1, 0.5f, mt);
+
+		std::deque< glm::vec2 > deque(points.begin(), points.end());
+		RingBuffer< glm::vec2 > ring;
+		for (auto const &p : points) ring.push_back(p);
+
+		//the head moves on, the tail follows:
+		size_t churns = std::max< size_t >(n, 100000);
+		size_t deque_allocs = allocations;
+		double deque_churn = time_per_op(churns, [&](){
+			for (size_t i = 0; i < churns; ++i) {
+				deque.push_front(deque.back());
+				deque.pop_back();
+			}
+		});
+		deque_allocs = allocations - deque_allocs;
+		size_t ring_allocs = allocations;
+		double ring_churn = time_per_op(churns, [&](){
+			for (size_t i = 0; i < churns; ++i) {
+				ring.push_front(ring.back());
+				ring.pop_back();
+			}
+		});
+		ring_allocs = allocations - ring_allocs;
+
+		double deque_walk = time_per_op(n, [&](){
+			float total = 0.0f;
+			auto it = deque.begin();
+			glm::vec2 prev = *it++;
+			for (; it != deque.end(); ++it) {
+				glm::vec2 d = *it - prev;
+				total += d.x * d.x + d.y * d.y;
+				prev = *it;
+			}
+			sink += size_t(total);
+		});
+		double ring_walk = time_per_op(n, [&](){
+			float total = 0.0f;
+			glm::vec2 prev = ring[0];
+			for (auto const &span : ring.spans()) {
+				for (glm::vec2 const &v : span) {
+					glm::vec2 d = v - prev;
+					total += d.x * d.x + d.y * d.y;
+					prev = v;
+				}
+			}
+			sink += size_t(total);
+		});
+
+		std::cout << std::setw(10) << n << std::fixed << std::setprecision(2)
+			<< std::setw(16) << deque_churn << std::setw(15) << ring_churn
+			<< std::setw(15) << deque_walk << std::setw(14) << ring_walk
+			<< std::setw(14) << deque_allocs << std::setw(13) << ring_allocs << "\n";
+	}
+	std::cout.flush();
+}
+
+static void bench_segments_within() {
+	std::cout << "--- point-vs-segments kernel (first_segment_within) ---\n";
+	std::cout << "(ns per query at collision-free points; 'old line' is the original distance-to-infinite-line loop, with pow --\n" "  it treats points near a segment's extension as hits, so it stops early on long snakes)\n";
+	std::cout << "(best implementation on this CPU: " << segments_impl_name(segments_best_impl()) << ")\n";
+	std::cout << std::setw(10) << "segments" << std::setw(12) << "old line";
+	std::vector< SegmentsImpl > impls;
+	for (SegmentsImpl impl : {SegmentsScalar, SegmentsSSE2, SegmentsAVX2}) {
+		if (!segments_impl_available(impl)) continue;
+		impls.emplace_back(impl);
+		std::cout << std::setw(10) << segments_impl_name(impl);
+	}
+	std::cout << std::setw(12) << "mismatches" << "\n";
+
+	std::mt19937 mt(0x5eed);
+	std::uniform_real_distribution< float > ux(-DefaultConfig::court_size.x, DefaultConfig::court_size.x);
+	std::uniform_real_distribution< float > uy(-DefaultConfig::court_size.y, DefaultConfig::court_size.y);
+	float const diameter = 2.0f * SnakeSim::snake_radius;
+
+	for (size_t segments = 4; segments <= 4096; segments *= 4) {
+		std::vector< glm::vec2 > points = wandering_snake(segments, 0.5f, mt);
+		std::vector< float > ax, ay, dx, dy, inv_len2;
+		for (size_t i = 0; i + 1 < points.size(); ++i) {
+			glm::vec2 d = points[i+1] - points[i];
+			float len2 = d.x * d.x + d.y * d.y;
+			ax.emplace_back(points[i].x);
+			ay.emplace_back(points[i].y);
+			dx.emplace_back(d.x);
+			dy.emplace_back(d.y);
+			inv_len2.emplace_back(len2 > 0.0f ? 1.0f / len2 : 0.0f);
+		}
+		SegmentArrays arrays;
+		arrays.ax = ax.data();
+		arrays.ay = ay.data();
+		arrays.dx = dx.data();
+		arrays.dy = dy.data();
+		arrays.inv_len2 = inv_len2.data();
+		arrays.count = ax.size();
+
+		//every implementation must report the same first hit:
+		size_t mismatches = 0;
+		std::vector< glm::vec2 > heads;
+		for (uint32_t attempt = 0; attempt < 20000; ++attempt) {
+			glm::vec2 h = glm::vec2(ux(mt), uy(mt));
+			size_t first = first_segment_within(SegmentsScalar, arrays, h, diameter);
+			for (SegmentsImpl impl : impls) {
+				mismatches += (first_segment_within(impl, arrays, h, diameter) != first);
+			}
+			if (first == arrays.count && heads.size() < 1024) heads.emplace_back(h);
+		}
+		if (heads.empty()) continue;
+
+		double old_line = time_per_op(heads.size(), [&](){
+			size_t hits = 0;
+			for (auto const &head : heads) {
+				for (size_t i = 0; i + 1 < points.size(); ++i) {
+					glm::vec2 prev_vertex = points[i];
+					glm::vec2 cur_vertex = points[i+1];
+					glm::vec2 d = cur_vertex - prev_vertex;
+					float dist = std::abs((cur_vertex.y - prev_vertex.y) * head.x -
+							(cur_vertex.x - prev_vertex.x) * head.y +
+							cur_vertex.x * prev_vertex.y -
+							cur_vertex.y * prev_vertex.x) /
+						std::pow(d.x * d.x + d.y * d.y, 0.5f);
+					if (dist < diameter) {
+						hits += 1;
+						break;
+					}
+				}
+			}
+			sink += hits;
+		});
+
+		std::cout << std::setw(10) << arrays.count << std::fixed << std::setprecision(1) << std::setw(12) << old_line;
+		for (SegmentsImpl impl : impls) {
+			double t = time_per_op(heads.size(), [&](){
+				size_t total = 0;
+				for (auto const &head : heads) {
+					total += first_segment_within(impl, arrays, head, diameter);
+				}
+				sink += total;
+			});
+			std::cout << std::setw(10) << t;
+		}
+		std::cout << std::setw(12) << mismatches << "\n";
+	}
+	std::cout.flush();
+}
+
+static void bench_segment_quads() {
+	std::cout << "--- snake body quads (segment_quads) ---\n";
+	std::cout << "(ns per segment; 'scalar' is the loop PongMode used to run; 'threads' is the best implementation in chunks over a ThreadPool;\n"
+		"  mismatches counts segments whose corners differ in any bit from scalar's)\n";
+	ThreadPool pool;
+	std::cout << std::setw(10) << "segments";
+	std::vector< SegmentsImpl > impls;
+	for (SegmentsImpl impl : {SegmentsScalar, SegmentsSSE2, SegmentsAVX2}) {
+		if (!segments_impl_available(impl)) continue;
+		impls.emplace_back(impl);
+		std::cout << std::setw(10) << segments_impl_name(impl);
+	}
+	std::cout << std::setw(10) << "threads" << std::setw(12) << "mismatches" << "\n";
+
+	for (size_t segments = 10000; segments <= 1000000; segments *= 10) {
+		std::mt19937 mt(0x5eed);
+		std::vector< glm::vec2 > vertices = wandering_snake(segments, 0.05f, mt);
+		//every kind of segment the branches in segment_quad tell apart -- horizontal, vertical, and (after a bounce merge) zero-length:
+		for (size_t i = 1; i < vertices.size(); i += 37) vertices[i].y = vertices[i-1].y;
+		for (size_t i = 2; i < vertices.size(); i += 41) vertices[i].x = vertices[i-1].x;
+		for (size_t i = 3; i < vertices.size(); i += 997) vertices[i] = vertices[i-1];
+
+		std::vector< glm::vec2 > expected(4 * segments), corners(4 * segments);
+		segment_quads(SegmentsScalar, vertices.data(), segments, SnakeSim::snake_size, expected.data());
+		size_t mismatches = 0;
+		auto check = [&]() {
+			for (size_t i = 0; i < segments; ++i) {
+				mismatches += (std::memcmp(&expected[4 * i], &corners[4 * i], 4 * sizeof(glm::vec2)) != 0);
+			}
+			std::fill(corners.begin(), corners.end(), glm::vec2(0.0f));
+		};
+
+		std::cout << std::setw(10) << segments << std::fixed << std::setprecision(2);
+		for (SegmentsImpl impl : impls) {
+			double t = time_per_op(segments, [&](){
+				segment_quads(impl, vertices.data(), segments, SnakeSim::snake_size, corners.data());
+				sink += size_t(corners.back().x);
+			});
+			check();
+			std::cout << std::setw(10) << t;
+		}
+		size_t const chunk = 4096;
+		double t = time_per_op(segments, [&](){
+			pool.parallel_for((segments + chunk - 1) / chunk, [&](size_t c, size_t) {
+				size_t begin = c * chunk;
+				segment_quads(vertices.data() + begin, std::min(chunk, segments - begin), SnakeSim::snake_size, corners.data() + 4 * begin);
+			});
+			sink += size_t(corners.back().x);
+		});
+		check();
+		std::cout << std::setw(10) << t << std::setw(12) << mismatches << "\n";
+	}
+	std::cout.flush();
+}
+
+//length of game g's snake, measuring every segment:
+static float walk_length(SnakeSim const &sim, size_t g) {
+	RingBuffer< glm::vec2 > const &vertices = sim.snake_vertices[g];
+	float total = 0.0f;
+	for (size_t i = 0; i + 1 < vertices.size(); ++i) {
+		total += glm::length(vertices[i+1] - vertices[i]);
+	}
+	return total;
+}
+
+//point 'distance' along game g's snake, measuring segments from the head until it gets there:
+static glm::vec2 walk_point(SnakeSim const &sim, size_t g, float distance) {
+	RingBuffer< glm::vec2 > const &vertices = sim.snake_vertices[g];
+	for (size_t i = 0; i + 1 < vertices.size(); ++i) {
+		glm::vec2 d = vertices[i+1] - vertices[i];
+		float length = glm::length(d);
+		if (distance <= length) return vertices[i] + d * (length > 0.0f ? distance / length : 0.0f);
+		distance -= length;
+	}
+	return vertices.back();
+}
+
+static void bench_arc_length() {
+	std::cout << "--- snake length and point-along-snake: cached arc lengths vs measuring segments ---\n";
+	std::cout << "(ns per query; 'max error' is the largest difference between the two, in court units)\n";
+	std::cout << std::setw(10) << "segments" << std::setw(12) << "walk len" << std::setw(12) << "cached len" << std::setw(12) << "walk pt" << std::setw(12) << "cached pt" << std::setw(12) << "max error" << "\n";
+
+	std::mt19937 mt(0x5eed);
+
+	for (size_t segments = 16; segments <= 4096; segments *= 4) {
+		SnakeSim sim(1);
+		set_snake(sim, 0, wandering_snake(segments, 0.5f, mt));
+
+		float length = walk_length(sim, 0);
+		float error = std::abs(sim.body_length(0) - length);
+		std::uniform_real_distribution< float > ud(0.0f, length);
+		std::vector< float > distances;
+		for (uint32_t i = 0; i < 1024; ++i) {
+			distances.emplace_back(ud(mt));
+			error = std::max(error, glm::length(sim.point_along_body(0, distances.back()) - walk_point(sim, 0, distances.back())));
+		}
+
+		double walk_len = time_per_op(1000, [&](){
+			float total = 0.0f;
+			for (uint32_t i = 0; i < 1000; ++i) total += walk_length(sim, 0);
+			sink += size_t(total);
+		});
+		double cached_len = time_per_op(1000, [&](){
+			float total = 0.0f;
+			for (uint32_t i = 0; i < 1000; ++i) total += sim.body_length(0);
+			sink += size_t(total);
+		});
+		double walk_pt = time_per_op(distances.size(), [&](){
+			glm::vec2 total = glm::vec2(0.0f);
+			for (float d : distances) total += walk_point(sim, 0, d);
+			sink += size_t(std::abs(total.x));
+		});
+		double cached_pt = time_per_op(distances.size(), [&](){
+			glm::vec2 total = glm::vec2(0.0f);
+			for (float d : distances) total += sim.point_along_body(0, d);
+			sink += size_t(std::abs(total.x));
+		});
+
+		std::cout << std::setw(10) << segments << std::fixed << std::setprecision(1)
+			<< std::setw(12) << walk_len << std::setw(12) << cached_len
+			<< std::setw(12) << walk_pt << std::setw(12) << cached_pt
+			<< std::setw(12) << std::setprecision(6) << error << "\n";
+	}
+
+	//the cached lengths must keep up with the game -- trimming, growing, and bouncing:
+	SnakeSim sim(64, 0x5eed);
+	float worst = 0.0f;
+	for (uint32_t tick = 0; tick < 20000; ++tick) {
+		for (size_t g = 0; g < sim.size(); ++g) {
+			//chase the head with both paddles (and restart finished games) so games last:
+			if (!sim.running[g]) sim.setup(g);
+			glm::vec2 head = sim.snake_vertices[g][0];
+			sim.left_input[g] = (head.y > sim.left_paddle[g].y ? 1 : -1);
+			sim.right_paddle[g].y = head.y;
+		}
+		sim.update(1.0f / 60.0f);
+		for (size_t g = 0; g < sim.size(); ++g) {
+			worst = std::max(worst, std::abs(sim.body_length(g) - walk_length(sim, g)));
+		}
+	}
+	std::cout << "in-game: largest body_length error over " << 20000 * sim.size() << " updates: " << worst << "\n";
+	std::cout.flush();
+}
+
+static void bench_swept() {
+	std::cout << "--- swept collision: heads fired at the left paddle, one long update per step vs many short ones ---\n";
+	std::cout << "('missed' counts heads that got past the paddle to the wall; 'differ' counts heads whose coarse and fine runs disagree on that)\n";
+	std::cout << std::setw(12) << "step (sec)" << std::setw(12) << "head moves" << std::setw(10) << "missed" << std::setw(10) << "differ" << std::setw(14) << "max gap" << "\n";
+
+	std::mt19937 mt(0x5eed);
+	std::uniform_real_distribution< float > ux(-8.5f, -5.0f);
+	std::uniform_real_distribution< float > uy(-2.0f, 2.0f);
+	std::uniform_real_distribution< float > uvy(-0.5f, 0.5f);
+	float const duration = 0.8f;
+	uint32_t const fine_per_coarse = 32;
+
+	for (float step : {0.01f, 0.05f, 0.1f, 0.2f}) {
+		uint32_t missed = 0, differ = 0;
+		float max_gap = 0.0f;
+		for (uint32_t shot = 0; shot < 1000; ++shot) {
+			glm::vec2 head = glm::vec2(ux(mt), uy(mt));
+			glm::vec2 velocity = glm::vec2(-1.0f, uvy(mt));
+			SnakeSim coarse(1), fine(1);
+			for (SnakeSim *sim : {&coarse, &fine}) {
+				set_snake(*sim, 0, {head, head + glm::vec2(2.0f, 0.0f)});
+				sim->snake_velocity[0] = velocity;
+			}
+			uint32_t steps = uint32_t(std::round(duration / step));
+			for (uint32_t i = 0; i < steps; ++i) {
+				coarse.update(step);
+				for (uint32_t j = 0; j < fine_per_coarse; ++j) {
+					fine.update(step / fine_per_coarse);
+				}
+			}
+			//(counted directly, not from health -- fine rolls the red fruit chance 32x as often, and a heal can hide a miss)
+			bool coarse_missed = coarse.paddle_misses[0] > 0;
+			bool fine_missed = fine.paddle_misses[0] > 0;
+			missed += coarse_missed;
+			differ += (coarse_missed != fine_missed);
+			max_gap = std::max(max_gap, glm::length(coarse.snake_vertices[0][0] - fine.snake_vertices[0][0]));
+		}
+		float moves = step * std::min(2.0f + 0.5f * DefaultConfig::initial_snake_length, SnakeSim::max_speed);
+		std::cout << std::setw(12) << step << std::setw(12) << moves << std::setw(10) << missed << std::setw(10) << differ << std::setw(14) << max_gap << "\n";
+	}
+	std::cout.flush();
+}
+
+static void bench_config() {
+	std::cout << "--- tuning constants: updates specialized for DefaultConfig vs read from SnakeConfig at runtime ---\n";
+	std::cout << std::setw(10) << "games" << std::setw(16) << "default (ns)" << std::setw(16) << "runtime (ns)" << std::setw(10) << "same" << "\n";
+
+	float const elapsed = 1.0f / 60.0f;
+	size_t const steps = 2000;
+	for (size_t games : {16, 256, 4096}) {
+		SnakeSim specialized(games, 0x5eed), runtime(games, 0x5eed);
+		//perfect paddles, so games keep going:
+		auto follow = [](SnakeSim &sim) {
+			for (size_t g = 0; g < sim.size(); ++g) {
+				sim.left_paddle[g].y = sim.right_paddle[g].y = sim.snake_vertices[g][0].y;
+			}
+		};
+		double ns_default = time_per_op(steps * games, [&](){
+			for (size_t i = 0; i < steps; ++i) {
+				follow(specialized);
+				specialized.update(elapsed);
+			}
+		});
+		double ns_runtime = time_per_op(steps * games, [&](){
+			for (size_t i = 0; i < steps; ++i) {
+				follow(runtime);
+				runtime.update_with(0, runtime.size(), elapsed, runtime.config);
+			}
+		});
+		bool same = true;
+		for (size_t g = 0; g < games; ++g) {
+			same = same && (specialized.checksum(g) == runtime.checksum(g));
+		}
+		std::cout << std::setw(10) << games << std::setw(16) << ns_default << std::setw(16) << ns_runtime << std::setw(10) << (same ? "yes" : "NO") << "\n";
+	}
+	std::cout.flush();
+}
+
+static void bench_simplify() {
+	std::cout << "--- polyline simplification in push_head (tolerance < 0 keeps every vertex) ---\n";
+	std::cout << "stress: 4096 heads pushed along a gently curving path, every fourth one pushed twice\n";
+	std::cout << std::setw(12) << "tolerance" << std::setw(12) << "vertices" << std::setw(14) << "max error" << std::setw(16) << "hit test (ns)" << "\n";
+
+	std::mt19937 mt(0x5eed);
+	std::vector< glm::vec2 > path;
+	{
+		std::uniform_real_distribution< float > turn(-0.05f, 0.05f);
+		glm::vec2 at = glm::vec2(-8.0f, -4.0f);
+		float angle = 0.3f;
+		while (path.size() < 4096) {
+			path.emplace_back(at);
+			if (path.size() % 4 == 0) path.emplace_back(at);
+			angle += turn(mt);
+			at += 0.02f * glm::vec2(std::cos(angle), std::sin(angle));
+		}
+	}
+	std::uniform_real_distribution< float > ux(-DefaultConfig::court_size.x, DefaultConfig::court_size.x);
+	std::uniform_real_distribution< float > uy(-DefaultConfig::court_size.y, DefaultConfig::court_size.y);
+	std::vector< glm::vec2 > heads;
+	for (uint32_t i = 0; i < 1000; ++i) heads.emplace_back(ux(mt), uy(mt));
+
+	for (float tolerance : {-1.0f, 0.0f, 0.01f, 0.05f}) {
+		SnakeSim sim(1);
+		sim.snake_vertices[0].clear();
+		sim.body_grid[0].clear();
+		sim.body_segments[0].clear();
+		sim.head_serial[0] = 0;
+		sim.snake_vertices[0].emplace_back(path[0]);
+		sim.push_head(0, path[0]);
+		//(as in update: the head moves to the new point, then a vertex is left there)
+		for (size_t i = 1; i < path.size(); ++i) {
+			sim.snake_vertices[0][0] = path[i];
+			sim.push_head(0, path[i], tolerance);
+		}
+		RingBuffer< glm::vec2 > &vertices = sim.snake_vertices[0];
+
+		//how far is the farthest pushed point from the simplified snake?
+		float max_error = 0.0f;
+		for (glm::vec2 const &p : path) {
+			float best = 1e30f;
+			for (size_t i = 0; i + 1 < vertices.size(); ++i) {
+				glm::vec2 ab = vertices[i+1] - vertices[i];
+				float len2 = glm::dot(ab, ab);
+				float t = (len2 > 0.0f ? std::min(std::max(glm::dot(p - vertices[i], ab) / len2, 0.0f), 1.0f) : 0.0f);
+				best = std::min(best, glm::length(p - (vertices[i] + t * ab)));
+			}
+			max_error = std::max(max_error, best);
+		}
+
+		glm::vec2 head = vertices[0];
+		double ns = time_per_op(heads.size(), [&](){
+			size_t hits = 0;
+			for (glm::vec2 const &h : heads) {
+				vertices[0] = h;
+				hits += sim.head_hits_body(0);
+			}
+			sink = sink + hits;
+		});
+		vertices[0] = head;
+
+		std::cout << std::setw(12) << tolerance << std::setw(12) << vertices.size() << std::setw(14) << max_error << std::setw(16) << ns << "\n";
+	}
+
+	std::cout << "in-game: 512 games for 6000 updates, paddles following the head with a random offset\n";
+	std::cout << std::setw(12) << "tolerance" << std::setw(14) << "mean verts" << std::setw(12) << "max verts" << std::setw(16) << "update (ns)" << "\n";
+	for (float tolerance : {-1.0f, 0.0f, 0.01f, 0.05f}) {
+		SnakeConfig config;
+		config.simplify_tolerance = tolerance;
+		SnakeSim sim(512, 0x5eed, config);
+		std::mt19937 aim_mt(0x5eed);
+		std::uniform_real_distribution< float > aim(-0.9f, 0.9f);
+		double total = 0.0;
+		size_t most = 0;
+		double ns = time_per_op(6000 * sim.size(), [&](){
+			for (uint32_t step = 0; step < 6000; ++step) {
+				for (size_t g = 0; g < sim.size(); ++g) {
+					if (!sim.running[g]) sim.setup(g);
+					sim.left_paddle[g].y = sim.right_paddle[g].y = sim.snake_vertices[g][0].y + aim(aim_mt);
+				}
+				sim.update(1.0f / 60.0f);
+				for (size_t g = 0; g < sim.size(); ++g) {
+					total += sim.snake_vertices[g].size();
+					most = std::max(most, sim.snake_vertices[g].size());
+				}
+			}
+		});
+		std::cout << std::setw(12) << tolerance << std::setw(14) << total / (5.0 * 6000 * sim.size()) << std::setw(12) << most << std::setw(16) << ns << "\n";
+	}
+	std::cout.flush();
+}
+
+static void bench_spawn() {
+	std::cout << "--- random numbers: CounterRng vs std::mt19937 ---\n";
+	{
+		size_t const count = 1 << 22;
+		std::mt19937 mt(0x5eed);
+		CounterRng rng(0x5eed);
+		double ns_mt = time_per_op(count, [&](){
+			uint32_t x = 0;
+			for (size_t i = 0; i < count; ++i) x ^= mt();
+			sink = sink + x;
+		});
+		double ns_rng = time_per_op(count, [&](){
+			uint32_t x = 0;
+			for (size_t i = 0; i < count; ++i) x ^= rng();
+			sink = sink + x;
+		});
+		std::cout << "mt19937 " << ns_mt << " ns per number, CounterRng " << ns_rng << " ns per number (" << sizeof(mt) << " vs " << sizeof(rng) << " bytes of state)\n";
+	}
+
+	std::cout << "--- fruit spawning: free cells of body_cells vs uniform in the spawn area ---\n";
+	std::cout << "('overlaps' counts spawns within a snake + fruit radius of the body, out of 10000)\n";
+	std::cout << std::setw(10) << "segments" << std::setw(12) << "free cells" << std::setw(14) << "spawn (ns)" << std::setw(12) << "overlaps" << std::setw(18) << "uniform overlaps" << "\n";
+	std::mt19937 mt(0x5eed);
+	float const reach = SnakeSim::snake_radius + SnakeSim::fruit_radius;
+	for (size_t segments = 4; segments <= 1024; segments *= 4) {
+		SnakeSim sim(1);
+		set_snake(sim, 0, wandering_snake(segments, 0.5f, mt));
+		RingBuffer< glm::vec2 > const &vertices = sim.snake_vertices[0];
+		auto overlaps = [&](glm::vec2 const &pt) {
+			for (size_t i = 0; i + 1 < vertices.size(); ++i) {
+				glm::vec2 ab = vertices[i+1] - vertices[i];
+				float len2 = glm::dot(ab, ab);
+				float t = (len2 > 0.0f ? std::min(std::max(glm::dot(pt - vertices[i], ab) / len2, 0.0f), 1.0f) : 0.0f);
+				if (glm::length(pt - (vertices[i] + t * ab)) < reach) return true;
+			}
+			return false;
+		};
+
+		double ns = time_per_op(10000, [&](){
+			glm::vec2 total = glm::vec2(0.0f);
+			for (uint32_t i = 0; i < 10000; ++i) total += sim.spawn_fruit(0);
+			sink = sink + size_t(total.x);
+		});
+		uint32_t spawned_overlaps = 0, uniform_overlaps = 0;
+		OccupancyGrid const &cells = sim.body_cells[0];
+		glm::vec2 const area = cells.cell_size * glm::vec2(cells.size);
+		for (uint32_t i = 0; i < 10000; ++i) {
+			spawned_overlaps += overlaps(sim.spawn_fruit(0));
+			uniform_overlaps += overlaps(cells.min + glm::vec2(sim.rng[0].uniform(), sim.rng[0].uniform()) * area);
+		}
+		std::cout << std::setw(10) << segments << std::setw(12) << cells.free_count() << std::setw(14) << ns
+			<< std::setw(12) << spawned_overlaps << std::setw(18) << uniform_overlaps << "\n";
+	}
+	std::cout.flush();
+}
+
+static void bench_events() {
+	std::cout << "--- event-driven fast-forward vs stepping every update (held paddles) ---\n";
+	std::cout << "('differ' counts runs where the two end with different bounces, damage, fruit, or vertex counts)\n";
+	std::cout << std::setw(12) << "updates/sec" << std::setw(10) << "runs" << std::setw(10) << "differ" << std::setw(14) << "max gap" << std::setw(16) << "updates/step"
+		<< std::setw(14) << "step (us)" << std::setw(14) << "events (us)" << "\n";
+
+	SnakeConfig config;
+	uint32_t const runs = 500;
+	float const duration = 10.0f;
+	for (float rate : {60.0f, 240.0f, 1000.0f}) {
+		float const tick = 1.0f / rate;
+		uint32_t const ticks = uint32_t(duration * rate);
+		std::mt19937 mt(0x5eed);
+		std::uniform_real_distribution< float > ux(-0.5f, 0.5f);
+		std::uniform_real_distribution< float > uy(-4.0f, 4.0f);
+
+		std::vector< SnakeSim > starts;
+		for (uint32_t run = 0; run < runs; ++run) {
+			starts.emplace_back(1, run, config);
+			SnakeSim &sim = starts.back();
+			//(from the usual start, the head meets the left paddle exactly at an update, so start it a bit off)
+			sim.snake_vertices[0][0].x = ux(mt);
+			sim.left_paddle[0].y = uy(mt);
+			sim.right_paddle[0].y = uy(mt);
+			sim.health[0] = 1000; //(keep going through wall hits)
+		}
+
+		std::vector< SnakeSim > stepped = starts, skipped = starts;
+		size_t steps = 0;
+		double ns_step = time_per_op(runs, [&](){
+			stepped = starts;
+			for (SnakeSim &sim : stepped) {
+				for (uint32_t i = 0; i < ticks; ++i) sim.update(tick);
+			}
+		});
+		double ns_events = time_per_op(runs, [&](){
+			skipped = starts;
+			steps = 0;
+			for (SnakeSim &sim : skipped) {
+				for (uint32_t done = 0; done < ticks; ++steps) {
+					done += sim.fast_forward(0, tick, ticks - done);
+				}
+			}
+		});
+
+		uint32_t differ = 0;
+		float max_gap = 0.0f;
+		for (uint32_t run = 0; run < runs; ++run) {
+			SnakeSim const &a = stepped[run], &b = skipped[run];
+			if (a.head_serial[0] != b.head_serial[0] || a.health[0] != b.health[0] || a.green_fruit_eaten[0] != b.green_fruit_eaten[0] || a.red_fruit_heals[0] != b.red_fruit_heals[0]
+			 || a.snake_vertices[0].size() != b.snake_vertices[0].size() || a.ticks[0] != b.ticks[0]) {
+				differ += 1;
+			} else {
+				max_gap = std::max(max_gap, glm::length(a.snake_vertices[0][0] - b.snake_vertices[0][0]));
+			}
+		}
+		std::cout << std::setw(12) << rate << std::setw(10) << runs << std::setw(10) << differ << std::setw(14) << max_gap
+			<< std::setw(16) << double(ticks) * runs / steps << std::setw(14) << ns_step * 1e-3 << std::setw(14) << ns_events * 1e-3 << "\n";
+	}
+	std::cout.flush();
+}
+
+//replaces every arena snake with a random wander of 'segments' segments (and enough health to keep going):
+static void wandering_arena(ArenaSim &arena, size_t segments, float step, std::mt19937 &mt) {
+	glm::vec2 const limit = arena.sim.config.court_size - SnakeSim::snake_size;
+	std::uniform_real_distribution< float > ux(-limit.x, limit.x), uy(-limit.y, limit.y);
+	for (size_t s = 0; s < arena.size(); ++s) {
+		set_snake(arena.sim, s, wandering_snake(segments, step, mt, glm::vec2(ux(mt), uy(mt)), arena.sim.config.court_size));
+		arena.sim.health[s] = 1000000;
+	}
+}
+
+static void bench_arena() {
+	std::cout << "--- arena: sweep-and-prune head-vs-body contacts vs scanning every segment ---\n";
+	{
+		//(default court, so snakes are crowded and contacts are common)
+		std::mt19937 mt(0x5eed);
+		ArenaSim arena(32, 0x5eed);
+		wandering_arena(arena, 100, 0.1f, mt);
+		uint32_t const ticks = 600;
+		size_t checked = 0, touching = 0, mismatches = 0;
+		for (uint32_t t = 0; t < ticks; ++t) {
+			arena.update(1.0f / 120.0f);
+			std::vector< uint8_t > hit(arena.size(), 0);
+			for (size_t c = 0; c < arena.candidates.size(); ++c) {
+				if (arena.candidate_hits[c]) hit[arena.candidates[c].first] = 1;
+			}
+			for (size_t s = 0; s < arena.size(); ++s) {
+				if (!arena.sim.running[s]) continue;
+				bool scan = arena.head_hits_other_scan(s);
+				checked += 1;
+				touching += scan;
+				mismatches += (scan != bool(hit[s]));
+			}
+		}
+		std::cout << "32 snakes x 100 segments, " << ticks << " updates: " << checked << " heads checked, " << touching << " touching, " << mismatches << " mismatches\n";
+	}
+
+	std::cout << "(256 snakes x 1000 segments in a 96x60 court at 120 updates/sec -- " << 1000.0f / 120.0f << " ms per update)\n";
+	std::cout << std::setw(10) << "threads" << std::setw(12) << "sim (ms)" << std::setw(14) << "proxies (ms)" << std::setw(12) << "sweep (ms)" << std::setw(14) << "narrow (ms)"
+		<< std::setw(12) << "total (ms)" << std::setw(12) << "candidates" << std::setw(12) << "scan (ms)" << "\n";
+	ThreadPool pool;
+	for (ThreadPool *use : {(ThreadPool *)nullptr, &pool}) {
+		std::mt19937 mt(0x5eed);
+		SnakeConfig config;
+		config.court_size = glm::vec2(48.0f, 30.0f);
+		ArenaSim arena(256, 0x5eed, config);
+		arena.pool = use;
+		wandering_arena(arena, 1000, 0.05f, mt);
+		arena.update(1.0f / 120.0f); //(builds and sorts every proxy)
+
+		uint32_t const ticks = 240;
+		double ms[4] = {0.0, 0.0, 0.0, 0.0};
+		size_t candidates = 0;
+		auto timed = [&](double &total, std::function< void() > const &fn) {
+			auto before = std::chrono::high_resolution_clock::now();
+			fn();
+			total += std::chrono::duration< double, std::milli >(std::chrono::high_resolution_clock::now() - before).count();
+		};
+		for (uint32_t t = 0; t < ticks; ++t) {
+			//(ArenaSim::update, a step at a time -- paddles and damage are skipped)
+			timed(ms[0], [&](){ arena.sim.update(1.0f / 120.0f); });
+			timed(ms[1], [&](){ arena.update_proxies(); });
+			timed(ms[2], [&](){ arena.find_candidates(); });
+			timed(ms[3], [&](){ arena.test_candidates(); });
+			candidates += arena.candidates.size();
+		}
+		double ms_scan = time_per_op(1, [&](){
+			size_t hits = 0;
+			for (size_t s = 0; s < arena.size(); ++s) hits += arena.head_hits_other_scan(s);
+			sink = sink + hits;
+		}) * 1e-6;
+		std::cout << std::setw(10) << (use ? use->size() : 1) << std::setw(12) << ms[0] / ticks << std::setw(14) << ms[1] / ticks << std::setw(12) << ms[2] / ticks << std::setw(14) << ms[3] / ticks
+			<< std::setw(12) << (ms[0] + ms[1] + ms[2] + ms[3]) / ticks << std::setw(12) << candidates / ticks << std::setw(12) << ms_scan << "\n";
+	}
+	std::cout.flush();
+}
+
+static void bench_bot() {
+	std::cout << "--- PaddleBot: cost per decision, and predicted vs actual paddle crossings ---\n";
+	size_t const games = 256;
+	float const tick = 1.0f / 60.0f;
+	SnakeSim sim(games);
+	std::vector< PaddleBot > bots;
+	for (size_t g = 0; g < games; ++g) {
+		bots.emplace_back(uint32_t(g), 5.0f);
+	}
+
+	//play a while, noting where the bot said the head would cross the paddle it was heading for
+	// and where the head actually bounced (the vertex left at the paddle):
+	std::vector< float > predicted(games, 0.0f), errors;
+	std::vector< float > heading(games, 0.0f);
+	uint32_t misses = 0;
+	for (uint32_t t = 0; t < 60 * 60; ++t) {
+		for (size_t g = 0; g < games; ++g) {
+			if (!sim.running[g]) continue;
+			bool leftward = sim.snake_velocity[g].x < 0.0f;
+			if ((sim.snake_velocity[g].x > 0.0f) != (heading[g] > 0.0f)) {
+				if (heading[g] != 0.0f && sim.snake_vertices[g].size() > 1) errors.emplace_back(std::abs(sim.snake_vertices[g][1].y - predicted[g]));
+				heading[g] = sim.snake_velocity[g].x;
+				glm::vec2 const reach = SnakeSim::paddle_size + SnakeSim::snake_size;
+				float plane = (leftward ? sim.left_paddle[g].x + reach.x : sim.right_paddle[g].x - reach.x);
+				float arrival, velocity_y;
+				predicted[g] = PaddleBot::crossing(sim.snake_vertices[g][0], sim.head_speed(g) * sim.snake_velocity[g], plane,
+					sim.config.court_size.y - SnakeSim::snake_size.y, &arrival, &velocity_y);
+			}
+			bots[g].play(sim, g, tick);
+			sim.health[g] = 100; //(keep playing)
+		}
+		uint32_t before = 0;
+		for (size_t g = 0; g < games; ++g) before += sim.paddle_misses[g];
+		sim.update(tick);
+		for (size_t g = 0; g < games; ++g) misses += sim.paddle_misses[g];
+		misses -= before;
+	}
+	std::sort(errors.begin(), errors.end());
+	std::cout << errors.size() << " bounces (" << misses << " misses): crossing error p50 " << errors[errors.size() / 2]
+		<< ", p99 " << errors[errors.size() * 99 / 100] << ", max " << errors.back() << "\n";
+
+	double ns = time_per_op(games * 100, [&](){
+		int total = 0;
+		for (uint32_t i = 0; i < 100; ++i) {
+			for (size_t g = 0; g < games; ++g) {
+				PaddleBot::Decision d = bots[g].decide(sim, g, tick);
+				total += d.left_input + int(d.right_paddle);
+			}
+		}
+		sink = sink + size_t(total);
+	});
+	double ns_update = time_per_op(games * 100, [&](){
+		SnakeSim copy = sim;
+		for (uint32_t i = 0; i < 100; ++i) copy.update(tick);
+	});
+	std::cout << ns << " ns per decision (vs " << ns_update << " ns per game update)\n";
+	std::cout.flush();
+}
+
+static void bench_rollback() {
+	std::cout << "--- rollback: save every update, restore up to 15 updates back, re-run with the same inputs ---\n";
+	std::cout << "('differ' counts restores whose state, or re-run state, doesn't match the original's checksum,\n"
+		"  body_segments arc_total, or body_length -- the checksum skips the arc lengths)\n";
+	std::cout << std::setw(14) << "end vertices" << std::setw(10) << "restores" << std::setw(10) << "differ" << std::setw(12) << "save (ns)"
+		<< std::setw(14) << "restore (ns)" << std::setw(16) << "copy game (ns)" << "\n";
+	float const tick = 1.0f / 60.0f;
+	for (size_t segments : {0, 100, 1000, 10000}) {
+		std::mt19937 mt(0x5eed);
+		SnakeSim sim(1, 0x5eed);
+		if (segments) {
+			set_snake(sim, 0, wandering_snake(segments, 0.5f, mt));
+			sim.snake_length[0] = sim.body_length(0);
+		}
+		sim.health[0] = 1000000; //(keep going through body hits)
+		PaddleBot bot(0x5eed, 5.0f);
+
+		//play, keeping every update's inputs and checksum:
+		uint32_t const updates = 600;
+		std::vector< PaddleBot::Decision > inputs;
+		//(everything that must come back exactly)
+		struct State {
+			uint64_t checksum;
+			double arc_total;
+			float body_length;
+			bool operator==(State const &o) const {
+				return checksum == o.checksum && arc_total == o.arc_total && body_length == o.body_length;
+			}
+		};
+		auto state = [&sim]() {
+			return State{sim.checksum(0), sim.body_segments[0].arc_total, sim.body_length(0)};
+		};
+		std::vector< State > states;
+		Rollback rollback(sim, 0);
+		std::uniform_int_distribution< uint32_t > back(1, rollback.capacity() - 1);
+		uint32_t restores = 0, differ = 0;
+		double ns_save = 0.0, ns_restore = 0.0;
+		for (uint32_t t = 0; t < updates; ++t) {
+			states.emplace_back(state());
+			auto before = std::chrono::high_resolution_clock::now();
+			rollback.save(sim);
+			ns_save += std::chrono::duration< double, std::nano >(std::chrono::high_resolution_clock::now() - before).count();
+
+			//every so often, go back and re-run to here:
+			if (t % 10 == 9 && rollback.size() == rollback.capacity()) {
+				uint32_t age = back(mt);
+				before = std::chrono::high_resolution_clock::now();
+				rollback.restore(sim, age);
+				ns_restore += std::chrono::duration< double, std::nano >(std::chrono::high_resolution_clock::now() - before).count();
+				restores += 1;
+				bool same = (state() == states[t - age]);
+				for (uint32_t r = t - age; r < t; ++r) {
+					sim.left_input[0] = inputs[r].left_input;
+					sim.right_paddle[0].y = inputs[r].right_paddle;
+					sim.update(tick);
+					rollback.save(sim);
+					same = same && (state() == states[r + 1]);
+				}
+				differ += !same;
+			}
+
+			inputs.emplace_back(bot.decide(sim, 0, tick));
+			sim.left_input[0] = inputs.back().left_input;
+			sim.right_paddle[0].y = inputs.back().right_paddle;
+			sim.update(tick);
+		}
+
+		double ns_copy = time_per_op(100, [&](){
+			for (uint32_t i = 0; i < 100; ++i) {
+				SnakeSim copy = sim;
+				sink = sink + copy.snake_vertices[0].size();
+			}
+		});
+		std::cout << std::setw(14) << sim.snake_vertices[0].size() << std::setw(10) << restores << std::setw(10) << differ << std::setw(12) << ns_save / updates
+			<< std::setw(14) << ns_restore / restores << std::setw(16) << ns_copy << "\n";
+	}
+	std::cout.flush();
+}
+
+int main(int argc, char **argv) {
+	std::vector< std::pair< std::string, std::function< void() > > > benchmarks = {
+		{"body_grid", bench_body_grid},
+		{"ring_buffer", bench_ring_buffer},
+		{"segments_within", bench_segments_within},
+		{"segment_quads", bench_segment_quads},
+		{"arc_length", bench_arc_length},
+		{"swept", bench_swept},
+		{"config", bench_config},
+		{"simplify", bench_simplify},
+		{"spawn", bench_spawn},
+		{"events", bench_events},
+		{"arena", bench_arena},
+		{"bot", bench_bot},
+		{"rollback", bench_rollback},
+	};
+
+	for (auto const &b : benchmarks) {
+		bool run = (argc == 1);
+		for (int i = 1; i < argc; ++i) {
+			if (b.first == argv[i]) run = true;
+		}
+		if (run) b.second();
+	}
+
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include "bot_games.hpp"
+
+#include "SnakeSim.hpp"
+#include "PaddleBot.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+void play_bot_games(SnakeConfig const &config, size_t first, size_t count, float elapsed, uint32_t max_ticks, float bot_speed, GameOutcome *outcomes, bool events) {
+	SnakeSim sim(0, 0, config);
+	sim.add_games(count, uint32_t(first));
+
+	//each game's bots aim with their own random stream (same seed as the game, different stream):
+	std::vector< PaddleBot > bots;
+	for (size_t g = 0; g < count; ++g) {
+		bots.emplace_back(uint32_t(first + g), bot_speed);
+	}
+	std::vector< uint32_t > steps(count);
+
+	if (events) {
+		for (size_t g = 0; g < sim.size(); ++g) {
+			while (sim.running[g] && sim.ticks[g] < max_ticks) {
+				PaddleBot &bot = bots[g];
+				bot.re_aim(sim, g);
+				PaddleBot::Targets t = bot.targets(sim, g);
+				//only the paddle the head is headed for moves, as far as it could by the time the head gets there
+				// (the left bot moves like holding a key, paddle_step per update):
+				if (sim.snake_velocity[g].x < 0.0f) {
+					float most = SnakeSim::paddle_step / elapsed * t.left_arrival;
+					sim.left_paddle[g].y += std::min(std::max(t.left - sim.left_paddle[g].y, -most), most);
+				} else {
+					float most = bot_speed * t.right_arrival;
+					sim.right_paddle[g].y += std::min(std::max(t.right - sim.right_paddle[g].y, -most), most);
+				}
+
+				sim.fast_forward(g, elapsed, max_ticks - sim.ticks[g]);
+				steps[g] += 1;
+			}
+		}
+	}
+
+	for (uint32_t tick = 0; tick < max_ticks && !events; ++tick) {
+		size_t alive = 0;
+		for (size_t g = 0; g < sim.size(); ++g) {
+			if (!sim.running[g]) continue;
+			alive += 1;
+			steps[g] += 1;
+			bots[g].play(sim, g, elapsed);
+		}
+		if (alive == 0) break;
+		sim.update(elapsed);
+	}
+
+	for (size_t g = 0; g < sim.size(); ++g) {
+		GameOutcome &o = outcomes[g];
+		o.time = sim.time[g];
+		o.length = sim.snake_length[g];
+		o.paddle_misses = sim.paddle_misses[g];
+		o.body_hits = sim.body_hits[g];
+		o.green_fruit_eaten = sim.green_fruit_eaten[g];
+		o.red_fruit_heals = sim.red_fruit_heals[g];
+		o.survived = sim.running[g] != 0;
+		o.steps = steps[g];
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SnakeConfig.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Complete games of SnakeSim played by simple bots, for offline statistics
+ * (used by 'montecarlo' and 'sweep').
+ *
+ * Both paddles are played by a PaddleBot (which moves them to where the head
+ * will cross); the right-hand (mouse) paddle can only move 'bot_speed' per second.
+ *
+ * With 'events' set, games are fast-forwarded from event to event (SnakeSim::fast_forward)
+ * instead of stepped every update; the bots then only act at events, moving the paddle the
+ * head is headed for toward where it will arrive (as far as they could get by then).
+ */
+
+//how one game went:
+struct GameOutcome {
+	float time; //seconds played
+	float length; //final snake_length
+	uint32_t paddle_misses;
+	uint32_t body_hits;
+	uint32_t green_fruit_eaten;
+	uint32_t red_fruit_heals;
+	bool survived; //still running at the time limit
+	uint32_t steps; //calls to SnakeSim::update or fast_forward it took
+};
+
+//plays games [first, first + count) with 'config' until they end (or 'max_ticks' updates of 'elapsed' seconds)
+// and writes their outcomes to outcomes[0, count);
+//game g's fruit and the bots' aim are seeded from g, so results don't depend on how games are split up:
+void play_bot_games(SnakeConfig const &config, size_t first, size_t count, float elapsed, uint32_t max_ticks, float bot_speed, GameOutcome *outcomes, bool events = false);
+
+//play_bot_games is fastest (and most parallel) in batches of about this many games:
+static size_t const bot_games_batch = 256;
@@ -0,0 +1,179 @@
+//drawbench times PongMode::draw with long snakes, once for each way it can draw them (PongMode::draw_path).
+// usage: drawbench [frames] [segments ...]
+//  (renders offscreen at 960x600 in a hidden window; for each path, reports the CPU time spent in draw,
+//   the time until the GPU has finished the frame too, the bytes uploaded per frame, and the state-setting GL calls
+//   made and skipped per frame)
+
+#include "PongMode.hpp"
+#include "GL.hpp"
+#include "gl_errors.hpp"
+
+#include <SDL.h>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+
+//replaces game g's snake with 'vertices' (head first), going through push_head so the body_grid and body_segments are filled:
+static void set_snake(SnakeSim &sim, size_t g, std::vector< glm::vec2 > const &vertices) {
+	sim.snake_vertices[g].clear();
+	sim.body_grid[g].clear();
+	sim.body_segments[g].clear();
+	sim.body_cells[g].clear();
+	sim.head_serial[g] = 0;
+	sim.neck_error[g] = 0.0f;
+	sim.snake_vertices[g].emplace_back(vertices.back());
+	for (size_t i = vertices.size() - 1; i > 0; --i) {
+		sim.push_head(g, vertices[i-1]);
+	}
+}
+
+//a snake of 'count' segments, each 'step' long, wandering around the court:
+static std::vector< glm::vec2 > wandering_snake(size_t count, float step, std::mt19937 &mt) {
+	glm::vec2 limit = DefaultConfig::court_size - SnakeSim::snake_size;
+	std::uniform_real_distribution< float > turn(-0.6f, 0.6f);
+	std::vector< glm::vec2 > vertices;
+	glm::vec2 at = glm::vec2(0.0f);
+	float angle = 0.0f;
+	vertices.emplace_back(at);
+	while (vertices.size() <= count) {
+		angle += turn(mt);
+		glm::vec2 next = at + step * glm::vec2(std::cos(angle), std::sin(angle));
+		//bounce off the walls:
+		if (next.x < -limit.x || next.x > limit.x) {
+			angle = 3.14159265f - angle;
+			continue;
+		}
+		if (next.y < -limit.y || next.y > limit.y) {
+			angle = -angle;
+			continue;
+		}
+		at = next;
+		vertices.emplace_back(at);
+	}
+	return vertices;
+}
+
+int main(int argc, char **argv) {
+	uint32_t frames = 60;
+	std::vector< size_t > segment_counts;
+	try {
+		if (argc > 1) frames = uint32_t(std::stoul(argv[1]));
+		for (int i = 2; i < argc; ++i) segment_counts.emplace_back(std::stoul(argv[i]));
+	} catch (std::exception const &e) {
+		std::cerr << "usage: " << argv[0] << " [frames] [segments ...]" << std::endl;
+		return 1;
+	}
+	if (frames == 0) frames = 1;
+	if (segment_counts.empty()) segment_counts = {0, 1000, 10000, 100000};
+
+	//------------  initialization (as in main.cpp, but with a hidden window) ------------
+	SDL_Init(SDL_INIT_VIDEO);
+
+	SDL_GL_ResetAttributes();
+	SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+
+	SDL_Window *window = SDL_CreateWindow(
+		"drawbench",
+		SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+		64, 64,
+		SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
+	);
+	if (!window) {
+		std::cerr << "Error creating SDL window: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+
+	SDL_GLContext context = SDL_GL_CreateContext(window);
+	if (!context) {
+		SDL_DestroyWindow(window);
+		std::cerr << "Error creating OpenGL context: " << SDL_GetError() << std::endl;
+		return 1;
+	}
+
+	init_GL();
+
+	//draw into a framebuffer of our own (a hidden window's pixels may not get drawn at all):
+	glm::uvec2 const size = glm::uvec2(960, 600);
+	GLuint framebuffer = 0, color = 0;
+	glGenRenderbuffers(1, &color);
+	glBindRenderbuffer(GL_RENDERBUFFER, color);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+	glViewport(0, 0, size.x, size.y);
+	GL_ERRORS();
+
+	//------------  benchmark ------------
+	std::vector< std::pair< PongMode::DrawPath, std::string > > paths = {
+		{PongMode::DrawTriangles, "triangles"},
+		{PongMode::DrawRects, "rects"},
+		{PongMode::DrawSnakeVertices, "snake-vertices"},
+		{PongMode::DrawIndexed, "indexed"},
+	};
+
+	std::cout << "--- draw: a bot playing with a long snake, " << frames << " frames per path at " << size.x << "x" << size.y << " ---\n";
+	std::cout << "('cpu' is time spent in draw; 'finished' also waits for the GPU)\n";
+	std::cout << std::setw(10) << "segments" << std::setw(16) << "path" << std::setw(12) << "cpu (ms)"
+		<< std::setw(15) << "finished (ms)" << std::setw(16) << "bytes/frame" << std::setw(12) << "gl calls" << std::setw(12) << "skipped" << "\n";
+	for (size_t segments : segment_counts) {
+		for (auto const &path : paths) {
+			PongMode pong(0x5eed);
+			pong.autoplay = true;
+			pong.draw_path = path.first;
+			if (segments) {
+				std::mt19937 mt(0x5eed);
+				set_snake(pong.sim, 0, wandering_snake(segments, 0.05f, mt));
+				pong.sim.snake_length[0] = pong.sim.body_length(0);
+				pong.remember_state();
+			}
+
+			//(the first frame builds and uploads what later frames can keep, so it isn't counted)
+			pong.sim.health[0] = 3; //(keep going through body hits -- the snake would be gone if the game ended)
+			pong.update(Mode::tick);
+			pong.draw(size);
+			glFinish();
+			pong.draw_stats = PongMode::DrawStats();
+
+			double cpu = 0.0, finished = 0.0;
+			for (uint32_t f = 0; f < frames; ++f) {
+				pong.sim.health[0] = 3;
+				pong.update(Mode::tick);
+				pong.interpolation = 0.5f;
+				auto before = std::chrono::high_resolution_clock::now();
+				pong.draw(size);
+				auto drawn = std::chrono::high_resolution_clock::now();
+				glFinish();
+				auto after = std::chrono::high_resolution_clock::now();
+				cpu += std::chrono::duration< double, std::milli >(drawn - before).count();
+				finished += std::chrono::duration< double, std::milli >(after - before).count();
+			}
+			std::cout << std::setw(10) << segments << std::setw(16) << path.second << std::setw(12) << cpu / frames
+				<< std::setw(15) << finished / frames << std::setw(16) << pong.draw_stats.upload_bytes / frames
+				<< std::setw(12) << pong.draw_stats.gl_calls / frames << std::setw(12) << pong.draw_stats.gl_calls_elided / frames << std::endl;
+		}
+	}
+
+	//------------  teardown ------------
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &color);
+
+	SDL_GL_DeleteContext(context);
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+
+	return 0;
+}
@@ -19,6 +19,8 @@
 #include <stdexcept>
 #include <memory>
 #include <algorithm>
+#include <string>
+#include <random>
 
 int main(int argc, char **argv) {
 #ifdef _WIN32
@@ -26,6 +28,81 @@ int main(int argc, char **argv) {
 	try {
 #endif
 
+	//------------  command line ------------
+	// usage: pong [--record replay-file] [--autoplay] [--seed seed] [--netplay left|right local-port remote-host remote-port] [--draw-stats] [--draw triangles|rects|snake-vertices|indexed] [updates per second]
+	//  (game logic runs at this fixed rate no matter how fast frames are drawn;
+	//   with --record, the whole session (every game so far) is saved for playback with the 'replay' tool each time a game ends;
+	//   with --autoplay, a bot plays both paddles and games restart by themselves;
+	//   with --netplay, this plays one paddle against another 'pong --netplay' over UDP --
+	//   both need the same seed and updates per second, and --autoplay puts a bot on this side's paddle;
+	//   with --draw-stats, drawing reports what it uploads (and the GL state calls it makes and skips) every 60 frames;
+	//   --draw picks how the scene gets to the GPU: as triangles (the default), as one instanced rectangle each,
+	//   as triangles but with the snake's quads made on the GPU from its vertices, or as indexed quads of compact
+	//   vertices -- see 'drawbench')
+	std::string usage = std::string("usage: ") + argv[0] + " [--record replay-file] [--autoplay] [--seed seed]"
+		+ " [--netplay left|right local-port remote-host remote-port] [--draw-stats] [--draw triangles|rects|snake-vertices|indexed] [updates per second]";
+	std::string record_filename;
+	bool autoplay = false;
+	bool draw_stats = false;
+	PongMode::DrawPath draw_path = PongMode::DrawTriangles;
+	bool seeded = false;
+	uint32_t seed = 0;
+	std::string netplay_side, netplay_host;
+	uint16_t netplay_port = 0, netplay_remote_port = 0;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		float tick_rate = 0.0f;
+		if (arg == "--record" && i + 1 < argc) {
+			record_filename = argv[i+1];
+			i += 1;
+			continue;
+		}
+		if (arg == "--autoplay") {
+			autoplay = true;
+			continue;
+		}
+		if (arg == "--draw-stats") {
+			draw_stats = true;
+			continue;
+		}
+		if (arg == "--draw" && i + 1 < argc) {
+			std::string path = argv[i+1];
+			if (path == "triangles") draw_path = PongMode::DrawTriangles;
+			else if (path == "rects") draw_path = PongMode::DrawRects;
+			else if (path == "snake-vertices") draw_path = PongMode::DrawSnakeVertices;
+			else if (path == "indexed") draw_path = PongMode::DrawIndexed;
+			else {
+				std::cerr << usage << std::endl;
+				return 1;
+			}
+			i += 1;
+			continue;
+		}
+		try {
+			if (arg == "--seed" && i + 1 < argc) {
+				seed = uint32_t(std::stoul(argv[i+1]));
+				seeded = true;
+				i += 1;
+				continue;
+			}
+			if (arg == "--netplay" && i + 4 < argc && (std::string(argv[i+1]) == "left" || std::string(argv[i+1]) == "right")) {
+				netplay_side = argv[i+1];
+				netplay_port = uint16_t(std::stoul(argv[i+2]));
+				netplay_host = argv[i+3];
+				netplay_remote_port = uint16_t(std::stoul(argv[i+4]));
+				i += 4;
+				continue;
+			}
+			tick_rate = std::stof(arg);
+		} catch (std::exception const &e) {
+		}
+		if (!(tick_rate > 0.0f)) {
+			std::cerr << usage << std::endl;
+			return 1;
+		}
+		Mode::tick = 1.0f / tick_rate;
+	}
+
 	//------------  initialization ------------
 
 	//Initialize SDL library:
@@ -87,7 +164,26 @@ int main(int argc, char **argv) {
 	//SDL_ShowCursor(SDL_DISABLE);
 
 	//------------ create game mode + make current --------------
-	Mode::set_current(std::make_shared< PongMode >());
+	{
+		//a new fruit sequence each run, unless asked for or playing over the network (the seed is saved with the replay):
+		if (!seeded && netplay_side.empty()) seed = std::random_device()();
+		std::shared_ptr< PongMode > pong = std::make_shared< PongMode >(seed);
+		pong->replay_filename = record_filename;
+		pong->autoplay = autoplay;
+		pong->print_draw_stats = draw_stats;
+		pong->draw_path = draw_path;
+		if (!netplay_side.empty()) {
+			try {
+				//(the seed doubles as the session, so peers with different seeds ignore each other)
+				pong->netplay.reset(new Netplay(netplay_side == "left" ? Netplay::Left : Netplay::Right,
+					netplay_port, netplay_host, netplay_remote_port, pong->replay.seed, Mode::tick));
+			} catch (std::exception const &e) {
+				std::cerr << e.what() << std::endl;
+				return 1;
+			}
+		}
+		Mode::set_current(pong);
+	}
 
 	//------------ main loop ------------
 
@@ -143,7 +239,7 @@ int main(int argc, char **argv) {
 			if (!Mode::current) break;
 		}
 
-		{ //(2) call the current mode's "update" function to deal with elapsed time:
+		{ //(2) call the current mode's "update" function once per fixed tick of elapsed time:
 			auto current_time = std::chrono::high_resolution_clock::now();
 			static auto previous_time = current_time;
 			float elapsed = std::chrono::duration< float >(current_time - previous_time).count();
@@ -153,8 +249,17 @@ int main(int argc, char **argv) {
 			//lag to avoid spiral of death:
 			elapsed = std::min(0.1f, elapsed);
 
-			Mode::current->update(elapsed);
+			//time not yet simulated (always less than one tick after the loop):
+			static float accumulated = 0.0f;
+			accumulated += elapsed;
+			while (accumulated >= Mode::tick) {
+				accumulated -= Mode::tick;
+				Mode::current->update(Mode::tick);
+				if (!Mode::current) break;
+			}
 			if (!Mode::current) break;
+
+			Mode::current->interpolation = accumulated / Mode::tick;
 		}
 
 		{ //(3) call the current mode's "draw" function to produce output:
@@ -0,0 +1,122 @@
+//montecarlo plays many complete games of SnakeSim on every core (no SDL, no OpenGL) with bot players (see bot_games.hpp),
+// and prints distributions of how the games went -- for answering balance questions offline.
+// usage: montecarlo [games] [threads] [max seconds per game] [updates per second] [bot paddle speed] [step|events]
+//  (threads 0 means one per core; bot paddle speed is how fast, in court units per second, the right-hand bot can move;
+//   'events' fast-forwards between collisions instead of running every update -- see bot_games.hpp)
+
+#include "bot_games.hpp"
+#include "SnakeSim.hpp"
+#include "ThreadPool.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+//prints mean and percentiles of 'values' (which it reorders):
+static void print_distribution(std::string const &name, std::vector< float > &values) {
+	double total = 0.0;
+	for (float v : values) total += v;
+	std::cout << std::setw(22) << std::left << name << std::right
+		<< " mean " << std::setw(8) << total / values.size();
+	for (float p : {0.05f, 0.25f, 0.5f, 0.75f, 0.95f}) {
+		size_t at = std::min(values.size() - 1, size_t(p * values.size()));
+		std::nth_element(values.begin(), values.begin() + at, values.end());
+		std::cout << "  p" << std::setw(2) << std::setfill('0') << int(std::round(p * 100.0f)) << std::setfill(' ')
+			<< " " << std::setw(8) << values[at];
+	}
+	std::cout << "\n";
+}
+
+int main(int argc, char **argv) {
+	size_t games = 100000;
+	size_t threads = 0;
+	float max_time = 300.0f;
+	float tick_rate = 60.0f;
+	float bot_speed = 5.0f;
+	std::string mode = "step";
+
+	try {
+		if (argc > 1) games = std::stoul(argv[1]);
+		if (argc > 2) threads = std::stoul(argv[2]);
+		if (argc > 3) max_time = std::stof(argv[3]);
+		if (argc > 4) tick_rate = std::stof(argv[4]);
+		if (argc > 5) bot_speed = std::stof(argv[5]);
+		if (argc > 6) mode = argv[6];
+		if (mode != "step" && mode != "events") throw std::runtime_error("mode should be 'step' or 'events'.");
+	} catch (std::exception const &e) {
+		std::cerr << "usage: " << argv[0] << " [games] [threads] [max seconds per game] [updates per second] [bot paddle speed] [step|events]" << std::endl;
+		return 1;
+	}
+	if (games == 0 || !(max_time > 0.0f) || !(tick_rate > 0.0f) || !(bot_speed >= 0.0f)) {
+		std::cerr << "games, max seconds, and update rate must all be positive." << std::endl;
+		return 1;
+	}
+
+	ThreadPool pool(threads);
+	float elapsed = 1.0f / tick_rate;
+	uint32_t max_ticks = uint32_t(max_time * tick_rate);
+	SnakeConfig config;
+	std::vector< GameOutcome > outcomes(games);
+
+	auto before = std::chrono::high_resolution_clock::now();
+
+	size_t batches = (games + bot_games_batch - 1) / bot_games_batch;
+	pool.parallel_for(batches, [&](size_t batch, size_t) {
+		size_t first = batch * bot_games_batch;
+		play_bot_games(config, first, std::min(bot_games_batch, games - first), elapsed, max_ticks, bot_speed, outcomes.data() + first, mode == "events");
+	});
+
+	auto after = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration< double >(after - before).count();
+
+	//----- report -----
+	std::vector< float > time, length, misses, hits, green, heals, steps;
+	size_t survived = 0, healed = 0;
+	double total_time = 0.0, total_misses = 0.0, total_hits = 0.0, total_heals = 0.0, total_steps = 0.0;
+	for (auto const &o : outcomes) {
+		time.emplace_back(o.time);
+		length.emplace_back(o.length);
+		misses.emplace_back(float(o.paddle_misses));
+		hits.emplace_back(float(o.body_hits));
+		green.emplace_back(float(o.green_fruit_eaten));
+		heals.emplace_back(float(o.red_fruit_heals));
+		steps.emplace_back(float(o.steps));
+		survived += o.survived;
+		healed += (o.red_fruit_heals > 0);
+		total_time += o.time;
+		total_misses += o.paddle_misses;
+		total_hits += o.body_hits;
+		total_heals += o.red_fruit_heals;
+		total_steps += o.steps;
+	}
+	double total_updates = total_time * tick_rate;
+
+	std::cout << "games: " << games << " at " << tick_rate << " updates/sec, up to " << max_time << " sec each; right bot speed " << bot_speed << "; " << mode << " mode\n";
+	std::cout << "threads: " << pool.size() << ", wall time: " << seconds << " sec ("
+		<< games / std::max(seconds, 1e-9) << " games/sec, " << total_updates / std::max(seconds, 1e-9) << " game updates/sec)\n";
+	std::cout << "survived to time limit: " << survived << " (" << 100.0 * survived / games << "%)\n";
+	print_distribution("game time (sec)", time);
+	print_distribution("final snake length", length);
+	print_distribution("paddle misses", misses);
+	print_distribution("body hits", hits);
+	print_distribution("green fruit eaten", green);
+	print_distribution("red fruit heals", heals);
+	print_distribution("simulation steps", steps);
+	std::cout << "updates per simulation step: " << total_updates / std::max(total_steps, 1.0) << "\n";
+
+	double miss_damage = total_misses * config.paddle_miss_damage;
+	double hit_damage = total_hits * config.collision_damage;
+	double damage = std::max(miss_damage + hit_damage, 1.0);
+	std::cout << "damage sources: paddle misses " << 100.0 * miss_damage / damage << "%, body hits " << 100.0 * hit_damage / damage << "%\n";
+	std::cout << "red fruit: " << total_heals * SnakeSim::red_fruit_heal << " health healed vs " << miss_damage + hit_damage << " taken; "
+		<< 60.0 * total_heals / std::max(total_time, 1e-9) << " heals per minute; "
+		<< 100.0 * healed / games << "% of games healed at least once\n";
+	std::cout.flush();
+
+	return 0;
+}
@@ -0,0 +1,165 @@
+//netplay plays a two-player game headless (no SDL, no OpenGL) in lockstep with another 'netplay' process over UDP,
+// with a bot on this side's paddle, and checks both copies of the game stay the same (every update's checksum is compared).
+// usage: netplay <left|right> <local port> <remote host> <remote port> [updates] [loss] [latency ms] [jitter ms] [seed]
+//        netplay loopback [updates] [loss] [latency ms] [jitter ms] [seed]
+//  (loss, latency, and jitter are simulated on outgoing packets; loopback runs both sides as two processes on 127.0.0.1,
+//   and -- like a single side -- exits non-zero if any update's state differs between them or goes unchecked)
+
+#include "Netplay.hpp"
+#include "SnakeSim.hpp"
+#include "PaddleBot.hpp"
+#include "Replay.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <thread>
+
+static int play(Netplay::Side side, uint16_t local_port, std::string const &remote_host, uint16_t remote_port,
+	uint32_t updates, float loss, float latency, float jitter, uint32_t seed) {
+
+	float const tick = 1.0f / 60.0f;
+	SnakeSim sim(1, seed);
+	//(each side's bot only plays its own paddle, so they needn't agree on anything)
+	PaddleBot bot(seed + side, 5.0f);
+	Netplay net(side, local_port, remote_host, remote_port, seed, tick);
+	net.loss = loss;
+	net.latency = latency;
+	net.jitter = jitter;
+
+	char const *name = (side == Netplay::Left ? "left" : "right");
+	float const give_up = 5.0f; //seconds without hearing from the other side
+
+	//run updates in real time (as pong's main loop does), except when waiting on the other side's input:
+	auto start = std::chrono::steady_clock::now();
+	auto seconds = [&start]() {
+		return std::chrono::duration< float >(std::chrono::steady_clock::now() - start).count();
+	};
+	float due = 0.0f; //time the next update should run
+	float stalled = 0.0f; //seconds spent waiting on the other side's input
+	while (net.update < updates) {
+		net.poll();
+		if (net.silence() > give_up) {
+			std::cerr << name << ": nothing from the other side for " << give_up << " seconds; giving up after " << net.update << " updates." << std::endl;
+			return 1;
+		}
+		float now = seconds();
+		if (now < due) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		PaddleBot::Decision d = bot.decide(sim, 0, tick);
+		Netplay::Input mine;
+		mine.value = (side == Netplay::Left ? float(d.left_input) : d.right_paddle);
+		mine.restart = !sim.running[0];
+		net.schedule(mine);
+		if (!net.ready()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			stalled += seconds() - now;
+			continue;
+		}
+
+		Netplay::Input left = net.input(Netplay::Left), right = net.input(Netplay::Right);
+		if (!sim.running[0] && (left.restart || right.restart)) Replay::apply(sim, 0, Replay::Restart, 0.0f);
+		Replay::apply(sim, 0, Replay::LeftInput, left.value);
+		Replay::apply(sim, 0, Replay::RightPaddle, right.value);
+		sim.update(tick);
+		net.advance(sim.checksum(0));
+		due += tick;
+	}
+
+	//keep answering until both sides have checked every update (or the other side goes quiet):
+	while ((net.checked < updates || net.remote_checked < updates) && net.silence() < 1.0f) {
+		net.poll();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	std::cout << name << ": " << net.update << " updates in " << seconds() << " sec (" << stalled << " sec waiting on input), "
+		<< "final checksum " << std::hex << sim.checksum(0) << std::dec << "\n"
+		<< name << ":   checked " << net.checked << ", desyncs " << net.desyncs;
+	if (net.desyncs) std::cout << " (first at update " << net.first_desync << ")";
+	std::cout << "; round trip " << net.rtt * 1000.0f << " ms (+/- " << net.rtt_deviation * 1000.0f << "), input delay " << net.delay << " updates\n"
+		<< name << ":   packets sent " << net.packets_sent << " (" << net.packets_dropped << " dropped on purpose), received " << net.packets_received << std::endl;
+
+	if (net.desyncs != 0) {
+		std::cout << name << ": DESYNC -- the two copies of the game differ." << std::endl;
+		return 1;
+	}
+	if (net.checked < updates) {
+		std::cout << name << ": only " << net.checked << " of " << updates << " updates were checked against the other side." << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	std::string usage = std::string("usage: ") + argv[0] + " <left|right> <local port> <remote host> <remote port> [updates] [loss] [latency ms] [jitter ms] [seed]\n"
+		+ "       " + argv[0] + " loopback [updates] [loss] [latency ms] [jitter ms] [seed]";
+	if (argc < 2) {
+		std::cerr << usage << std::endl;
+		return 1;
+	}
+	std::string mode = argv[1];
+	bool loopback = (mode == "loopback");
+	if (!loopback && (argc < 5 || (mode != "left" && mode != "right"))) {
+		std::cerr << usage << std::endl;
+		return 1;
+	}
+
+	uint16_t local_port = 0, remote_port = 0;
+	std::string remote_host;
+	uint32_t updates = 600;
+	float loss = 0.0f, latency = 0.0f, jitter = 0.0f;
+	uint32_t seed = 0;
+	try {
+		int at = 2;
+		if (!loopback) {
+			local_port = uint16_t(std::stoul(argv[2]));
+			remote_host = argv[3];
+			remote_port = uint16_t(std::stoul(argv[4]));
+			at = 5;
+		}
+		if (argc > at) updates = uint32_t(std::stoul(argv[at]));
+		if (argc > at + 1) loss = std::stof(argv[at + 1]);
+		if (argc > at + 2) latency = std::stof(argv[at + 2]) / 1000.0f;
+		if (argc > at + 3) jitter = std::stof(argv[at + 3]) / 1000.0f;
+		if (argc > at + 4) seed = uint32_t(std::stoul(argv[at + 4]));
+	} catch (std::exception const &e) {
+		std::cerr << usage << std::endl;
+		return 1;
+	}
+	if (updates == 0 || !(loss >= 0.0f && loss < 1.0f) || !(latency >= 0.0f) || !(jitter >= 0.0f)) {
+		std::cerr << "updates must be positive, loss in [0,1), and latency and jitter not negative." << std::endl;
+		return 1;
+	}
+
+	if (loopback) {
+		//run each side as its own process (std::system waits, so each gets a thread):
+		std::string rest = " " + std::to_string(updates) + " " + std::to_string(loss) + " " + std::to_string(latency * 1000.0f)
+			+ " " + std::to_string(jitter * 1000.0f) + " " + std::to_string(seed);
+		std::string left = std::string("\"") + argv[0] + "\" left 47810 127.0.0.1 47811" + rest;
+		std::string right = std::string("\"") + argv[0] + "\" right 47811 127.0.0.1 47810" + rest;
+		int left_status = 0, right_status = 0;
+		std::thread left_thread([&](){ left_status = std::system(left.c_str()); });
+		std::thread right_thread([&](){ right_status = std::system(right.c_str()); });
+		left_thread.join();
+		right_thread.join();
+		if (left_status != 0 || right_status != 0) {
+			std::cout << "loopback: FAILED (see above)." << std::endl;
+			return 1;
+		}
+		std::cout << "loopback: both sides agreed on every update." << std::endl;
+		return 0;
+	}
+
+	try {
+		return play(mode == "left" ? Netplay::Left : Netplay::Right, local_port, remote_host, remote_port,
+			updates, loss, latency, jitter, seed);
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,55 @@
+//replay re-runs a replay recorded by 'pong --record' headless (no SDL, no OpenGL), as fast as possible,
+// checks that it ends in the recorded state, and prints how long that took.
+// usage: replay <replay-file> [repetitions]
+
+#include "Replay.hpp"
+#include "SnakeSim.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+int main(int argc, char **argv) {
+	if (argc < 2 || argc > 3) {
+		std::cerr << "usage: " << argv[0] << " <replay-file> [repetitions]" << std::endl;
+		return 1;
+	}
+
+	Replay replay;
+	uint32_t repetitions = 1;
+	try {
+		replay = Replay::load(argv[1]);
+		if (argc > 2) repetitions = uint32_t(std::stoul(argv[2]));
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	if (repetitions == 0) repetitions = 1;
+
+	std::cout << "replay: " << replay.updates << " updates of " << replay.elapsed << " sec, "
+		<< replay.events.size() << " inputs, seed " << replay.seed << "\n";
+
+	auto before = std::chrono::high_resolution_clock::now();
+
+	uint64_t checksum = 0;
+	for (uint32_t r = 0; r < repetitions; ++r) {
+		SnakeSim sim(1, replay.seed);
+		replay.play(sim, 0);
+		checksum = sim.checksum(0);
+	}
+
+	auto after = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration< double >(after - before).count();
+
+	std::cout << "wall time: " << seconds << " sec for " << repetitions << " playback(s) ("
+		<< (double(replay.updates) * repetitions) / seconds << " game updates/sec)\n";
+
+	if (checksum != replay.checksum) {
+		std::cout << "MISMATCH: final state checksum " << std::hex << checksum
+			<< " differs from recorded " << replay.checksum << std::dec << std::endl;
+		return 1;
+	}
+	std::cout << "final state matches the recording." << std::endl;
+	return 0;
+}
@@ -0,0 +1,195 @@
+#include "segment_quads.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define QUADS_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#define TARGET_AVX2 //MSVC allows AVX2 intrinsics anywhere
+	#else
+		#define TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+//NOTE: as in segments_within.cpp, the vector versions perform segment_quad's float operations in the same order
+// (no fused multiply-adds), with its branches turned into selects between both sides. Both sides of the branch on
+// direction are computed in full, rather than one from the other with the signs flipped, so that even the NaN
+// corners of a zero-length segment come out with the same bits.
+
+static void quads_scalar(glm::vec2 const *vertices, size_t count, glm::vec2 const &size, glm::vec2 *corners) {
+	for (size_t i = 0; i < count; ++i) {
+		segment_quad(vertices[i+1], vertices[i], size, corners + 4 * i);
+	}
+}
+
+#ifdef QUADS_X86
+
+static inline __m128 select_sse2(__m128 mask, __m128 a, __m128 b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//segments [i, i+4):
+static inline void quads_sse2(glm::vec2 const *vertices, size_t i, __m128 sx, __m128 sy, float *out) {
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+	//(vertices are x,y pairs, so two loads hold four vertices and shuffle apart into their x's and y's)
+	float const *v = &vertices[i].x;
+	__m128 a0 = _mm_loadu_ps(v + 0), a1 = _mm_loadu_ps(v + 4);
+	__m128 b0 = _mm_loadu_ps(v + 2), b1 = _mm_loadu_ps(v + 6);
+	__m128 v2x = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0));
+	__m128 v2y = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+	__m128 v1x = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0));
+	__m128 v1y = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+
+	__m128 dx = _mm_sub_ps(v1x, v2x);
+	__m128 dy = _mm_sub_ps(v1y, v2y);
+	__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+	__m128 x_ratio = _mm_div_ps(_mm_and_ps(dx, abs_mask), length);
+	__m128 y_ratio = _mm_div_ps(_mm_and_ps(dy, abs_mask), length);
+
+	__m128 rising = _mm_or_ps(_mm_cmpeq_ps(dy, zero), _mm_cmpgt_ps(_mm_div_ps(dx, dy), zero));
+	__m128 left = _mm_cmplt_ps(dx, zero);
+	//(the left end is botleft or topleft, the right end topright or botright)
+	__m128 lx = select_sse2(left, v1x, v2x), ly = select_sse2(left, v1y, v2y);
+	__m128 rx = select_sse2(left, v2x, v1x), ry = select_sse2(left, v2y, v1y);
+
+	__m128 a = _mm_mul_ps(sx, x_ratio);
+	__m128 b = _mm_mul_ps(sy, y_ratio);
+	__m128 c = _mm_mul_ps(sx, y_ratio);
+	__m128 d = _mm_mul_ps(sy, x_ratio);
+
+	__m128 x0 = _mm_add_ps(_mm_sub_ps(lx, a), b);
+	__m128 x1 = _mm_add_ps(_mm_add_ps(rx, a), b);
+	__m128 x2 = _mm_sub_ps(_mm_add_ps(rx, a), b);
+	__m128 x3 = _mm_sub_ps(_mm_sub_ps(lx, a), b);
+
+	__m128 l_minus = _mm_sub_ps(ly, c), l_plus = _mm_add_ps(ly, c);
+	__m128 r_minus = _mm_sub_ps(ry, c), r_plus = _mm_add_ps(ry, c);
+	__m128 y0 = select_sse2(rising, _mm_sub_ps(l_minus, d), _mm_add_ps(l_plus, d));
+	__m128 y1 = select_sse2(rising, _mm_sub_ps(r_plus, d), _mm_add_ps(r_minus, d));
+	__m128 y2 = select_sse2(rising, _mm_add_ps(r_plus, d), _mm_sub_ps(r_minus, d));
+	__m128 y3 = select_sse2(rising, _mm_add_ps(l_minus, d), _mm_sub_ps(l_plus, d));
+
+	//back to four corners per segment:
+	__m128 c0_01 = _mm_unpacklo_ps(x0, y0), c0_23 = _mm_unpackhi_ps(x0, y0);
+	__m128 c1_01 = _mm_unpacklo_ps(x1, y1), c1_23 = _mm_unpackhi_ps(x1, y1);
+	__m128 c2_01 = _mm_unpacklo_ps(x2, y2), c2_23 = _mm_unpackhi_ps(x2, y2);
+	__m128 c3_01 = _mm_unpacklo_ps(x3, y3), c3_23 = _mm_unpackhi_ps(x3, y3);
+	float *o = out + 8 * i;
+	_mm_storeu_ps(o + 0, _mm_movelh_ps(c0_01, c1_01));
+	_mm_storeu_ps(o + 4, _mm_movelh_ps(c2_01, c3_01));
+	_mm_storeu_ps(o + 8, _mm_movehl_ps(c1_01, c0_01));
+	_mm_storeu_ps(o + 12, _mm_movehl_ps(c3_01, c2_01));
+	_mm_storeu_ps(o + 16, _mm_movelh_ps(c0_23, c1_23));
+	_mm_storeu_ps(o + 20, _mm_movelh_ps(c2_23, c3_23));
+	_mm_storeu_ps(o + 24, _mm_movehl_ps(c1_23, c0_23));
+	_mm_storeu_ps(o + 28, _mm_movehl_ps(c3_23, c2_23));
+}
+
+static void quads_sse2(glm::vec2 const *vertices, size_t count, glm::vec2 const &size, glm::vec2 *corners) {
+	__m128 const sx = _mm_set1_ps(size.x);
+	__m128 const sy = _mm_set1_ps(size.y);
+
+	size_t i = 0;
+	//(four segments read five vertices -- there are count + 1, so the loads stay in bounds)
+	for (; i + 4 <= count; i += 4) {
+		quads_sse2(vertices, i, sx, sy, &corners[0].x);
+	}
+	for (; i < count; ++i) {
+		segment_quad(vertices[i+1], vertices[i], size, corners + 4 * i);
+	}
+}
+
+//segments [i, i+8):
+TARGET_AVX2
+static inline void quads_avx2(glm::vec2 const *vertices, size_t i, __m256 sx, __m256 sy, float *out) {
+	__m256 const zero = _mm256_setzero_ps();
+	__m256 const abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+	//(shuffles stay within 128-bit halves, so the lanes hold segments 0 1 4 5 | 2 3 6 7 -- everything after is
+	// lane-by-lane, and the stores at the end put each segment back in its place)
+	float const *v = &vertices[i].x;
+	__m256 a0 = _mm256_loadu_ps(v + 0), a1 = _mm256_loadu_ps(v + 8);
+	__m256 b0 = _mm256_loadu_ps(v + 2), b1 = _mm256_loadu_ps(v + 10);
+	__m256 v2x = _mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0));
+	__m256 v2y = _mm256_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+	__m256 v1x = _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0));
+	__m256 v1y = _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+
+	__m256 dx = _mm256_sub_ps(v1x, v2x);
+	__m256 dy = _mm256_sub_ps(v1y, v2y);
+	__m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+	__m256 x_ratio = _mm256_div_ps(_mm256_and_ps(dx, abs_mask), length);
+	__m256 y_ratio = _mm256_div_ps(_mm256_and_ps(dy, abs_mask), length);
+
+	__m256 rising = _mm256_or_ps(_mm256_cmp_ps(dy, zero, _CMP_EQ_OQ), _mm256_cmp_ps(_mm256_div_ps(dx, dy), zero, _CMP_GT_OQ));
+	__m256 left = _mm256_cmp_ps(dx, zero, _CMP_LT_OQ);
+	__m256 lx = _mm256_blendv_ps(v2x, v1x, left), ly = _mm256_blendv_ps(v2y, v1y, left);
+	__m256 rx = _mm256_blendv_ps(v1x, v2x, left), ry = _mm256_blendv_ps(v1y, v2y, left);
+
+	__m256 a = _mm256_mul_ps(sx, x_ratio);
+	__m256 b = _mm256_mul_ps(sy, y_ratio);
+	__m256 c = _mm256_mul_ps(sx, y_ratio);
+	__m256 d = _mm256_mul_ps(sy, x_ratio);
+
+	__m256 r[8];
+	r[0] = _mm256_add_ps(_mm256_sub_ps(lx, a), b);
+	r[2] = _mm256_add_ps(_mm256_add_ps(rx, a), b);
+	r[4] = _mm256_sub_ps(_mm256_add_ps(rx, a), b);
+	r[6] = _mm256_sub_ps(_mm256_sub_ps(lx, a), b);
+
+	__m256 l_minus = _mm256_sub_ps(ly, c), l_plus = _mm256_add_ps(ly, c);
+	__m256 r_minus = _mm256_sub_ps(ry, c), r_plus = _mm256_add_ps(ry, c);
+	r[1] = _mm256_blendv_ps(_mm256_add_ps(l_plus, d), _mm256_sub_ps(l_minus, d), rising);
+	r[3] = _mm256_blendv_ps(_mm256_add_ps(r_minus, d), _mm256_sub_ps(r_plus, d), rising);
+	r[5] = _mm256_blendv_ps(_mm256_sub_ps(r_minus, d), _mm256_add_ps(r_plus, d), rising);
+	r[7] = _mm256_blendv_ps(_mm256_sub_ps(l_plus, d), _mm256_add_ps(l_minus, d), rising);
+
+	//transpose, so that each register is one segment's four corners:
+	__m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+	__m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+	__m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+	__m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+	__m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)), s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)), s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+	float *o = out + 8 * i;
+	_mm256_storeu_ps(o + 8 * 0, _mm256_permute2f128_ps(s0, s4, 0x20));
+	_mm256_storeu_ps(o + 8 * 1, _mm256_permute2f128_ps(s1, s5, 0x20));
+	_mm256_storeu_ps(o + 8 * 4, _mm256_permute2f128_ps(s2, s6, 0x20));
+	_mm256_storeu_ps(o + 8 * 5, _mm256_permute2f128_ps(s3, s7, 0x20));
+	_mm256_storeu_ps(o + 8 * 2, _mm256_permute2f128_ps(s0, s4, 0x31));
+	_mm256_storeu_ps(o + 8 * 3, _mm256_permute2f128_ps(s1, s5, 0x31));
+	_mm256_storeu_ps(o + 8 * 6, _mm256_permute2f128_ps(s2, s6, 0x31));
+	_mm256_storeu_ps(o + 8 * 7, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+TARGET_AVX2
+static void quads_avx2(glm::vec2 const *vertices, size_t count, glm::vec2 const &size, glm::vec2 *corners) {
+	__m256 const sx = _mm256_set1_ps(size.x);
+	__m256 const sy = _mm256_set1_ps(size.y);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		quads_avx2(vertices, i, sx, sy, &corners[0].x);
+	}
+	//(the last few are scalar code, but compiled here it is VEX-encoded, so there's no SSE/AVX transition)
+	for (; i < count; ++i) {
+		segment_quad(vertices[i+1], vertices[i], size, corners + 4 * i);
+	}
+}
+
+#endif //QUADS_X86
+
+void segment_quads(SegmentsImpl impl, glm::vec2 const *vertices, size_t count, glm::vec2 const &size, glm::vec2 *corners) {
+#ifdef QUADS_X86
+	if (impl == SegmentsAVX2 && segments_impl_available(SegmentsAVX2)) return quads_avx2(vertices, count, size, corners);
+	if (impl == SegmentsSSE2) return quads_sse2(vertices, count, size, corners);
+#endif
+	quads_scalar(vertices, count, size, corners);
+}
+
+void segment_quads(glm::vec2 const *vertices, size_t count, glm::vec2 const &size, glm::vec2 *corners) {
+	segment_quads(segments_best_impl(), vertices, count, size, corners);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "segments_within.hpp" //(for SegmentsImpl)
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstddef>
+
+/*
+ * Corners of the quads that draw a polyline (e.g., the snake's body) as one
+ * rectangle per segment, 'size' beyond each end and to either side.
+ *
+ * segment_quad does one segment; segment_quads does many at once, vectorized
+ * across segments (four or eight at a time, each lane one segment), with the
+ * same float operations in the same order, so every implementation writes
+ * exactly the same bytes as calling segment_quad on each segment.
+ */
+
+//corners of the quad around the segment from 'vertex1' to 'vertex2', counterclockwise
+// (requires vertex1 to be on top-left or bottom-right of vertex 2):
+inline void segment_quad(glm::vec2 const &vertex1, glm::vec2 const &vertex2, glm::vec2 const &size, glm::vec2 corners[4]) {
+	float length = glm::distance(vertex1, vertex2);
+	float x_ratio = std::abs(vertex1.x - vertex2.x) / length;
+	float y_ratio = std::abs(vertex1.y - vertex2.y) / length;
+
+	if(vertex1.y == vertex2.y ||
+		(vertex1.x - vertex2.x) / (vertex1.y - vertex2.y) > 0) {
+		const glm::vec2 &botleft = vertex1.x - vertex2.x < 0 ? vertex1 :
+			vertex2;
+		const glm::vec2 &topright = vertex1.x - vertex2.x < 0 ? vertex2 :
+			vertex1;
+
+		corners[0] = glm::vec2(botleft.x - size.x * x_ratio + size.y * y_ratio, botleft.y - size.x * y_ratio - size.y * x_ratio);
+		corners[1] = glm::vec2(topright.x + size.x * x_ratio + size.y * y_ratio, topright.y + size.x * y_ratio - size.y * x_ratio);
+		corners[2] = glm::vec2(topright.x + size.x * x_ratio - size.y * y_ratio, topright.y + size.x * y_ratio + size.y * x_ratio);
+		corners[3] = glm::vec2(botleft.x - size.x * x_ratio - size.y * y_ratio, botleft.y - size.x * y_ratio + size.y * x_ratio);
+	} else {
+		const glm::vec2 &topleft = vertex1.x - vertex2.x < 0 ? vertex1 :
+			vertex2;
+		const glm::vec2 &botright = vertex1.x - vertex2.x < 0 ? vertex2 :
+			vertex1;
+
+		corners[0] = glm::vec2(topleft.x - size.x * x_ratio + size.y * y_ratio, topleft.y + size.x * y_ratio + size.y * x_ratio);
+		corners[1] = glm::vec2(botright.x + size.x * x_ratio + size.y * y_ratio, botright.y - size.x * y_ratio + size.y * x_ratio);
+		corners[2] = glm::vec2(botright.x + size.x * x_ratio - size.y * y_ratio, botright.y - size.x * y_ratio - size.y * x_ratio);
+		corners[3] = glm::vec2(topleft.x - size.x * x_ratio - size.y * y_ratio, topleft.y + size.x * y_ratio - size.y * x_ratio);
+	}
+}
+
+//corners of the quads around 'count' segments of the polyline 'vertices' (which has count + 1 vertices):
+// segment i runs from vertices[i+1] to vertices[i], and its corners go to corners[4*i] .. corners[4*i+3]
+// (uses the widest instruction set the CPU supports, as first_segment_within does)
+void segment_quads(glm::vec2 const *vertices, size_t count, glm::vec2 const &size, glm::vec2 *corners);
+
+//...with a particular implementation (for testing and benchmarking):
+void segment_quads(SegmentsImpl impl, glm::vec2 const *vertices, size_t count, glm::vec2 const &size, glm::vec2 *corners);
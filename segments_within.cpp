@@ -0,0 +1,180 @@
+#include "segments_within.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define SEGMENTS_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define TARGET_AVX2 //MSVC allows AVX2 intrinsics anywhere
+	#else
+		#define TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+//NOTE: all implementations must perform the same float operations in the same order,
+// so that they agree exactly (no fused multiply-adds -- 'avx2' does not enable FMA).
+
+static inline bool within_scalar(SegmentArrays const &s, size_t i, glm::vec2 const &pt, float radius2) {
+	float px = pt.x - s.ax[i];
+	float py = pt.y - s.ay[i];
+	float t = (px * s.dx[i] + py * s.dy[i]) * s.inv_len2[i];
+	t = std::min(std::max(t, 0.0f), 1.0f);
+	float ex = px - t * s.dx[i];
+	float ey = py - t * s.dy[i];
+	return ex * ex + ey * ey < radius2;
+}
+
+static size_t first_within_scalar(SegmentArrays const &s, glm::vec2 const &pt, float radius2) {
+	for (size_t i = 0; i < s.count; ++i) {
+		if (within_scalar(s, i, pt, radius2)) return i;
+	}
+	return s.count;
+}
+
+#ifdef SEGMENTS_X86
+
+//lowest set bit of a (nonzero) mask:
+static inline int lowest_lane(int mask) {
+	int lane = 0;
+	while (!(mask & (1 << lane))) ++lane;
+	return lane;
+}
+
+//bitmask of which of segments [i, i+4) are within range:
+static inline int within_sse2(SegmentArrays const &s, size_t i, __m128 px, __m128 py, __m128 r2) {
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const one = _mm_set1_ps(1.0f);
+
+	__m128 dx = _mm_loadu_ps(s.dx + i);
+	__m128 dy = _mm_loadu_ps(s.dy + i);
+	__m128 rx = _mm_sub_ps(px, _mm_loadu_ps(s.ax + i));
+	__m128 ry = _mm_sub_ps(py, _mm_loadu_ps(s.ay + i));
+	__m128 t = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(rx, dx), _mm_mul_ps(ry, dy)), _mm_loadu_ps(s.inv_len2 + i));
+	t = _mm_min_ps(_mm_max_ps(t, zero), one);
+	__m128 ex = _mm_sub_ps(rx, _mm_mul_ps(t, dx));
+	__m128 ey = _mm_sub_ps(ry, _mm_mul_ps(t, dy));
+	__m128 d2 = _mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey));
+	return _mm_movemask_ps(_mm_cmplt_ps(d2, r2));
+}
+
+static size_t first_within_sse2(SegmentArrays const &s, glm::vec2 const &pt, float radius2) {
+	__m128 const px = _mm_set1_ps(pt.x);
+	__m128 const py = _mm_set1_ps(pt.y);
+	__m128 const r2 = _mm_set1_ps(radius2);
+
+	size_t i = 0;
+	for (; i + 4 <= s.count; i += 4) {
+		int mask = within_sse2(s, i, px, py, r2);
+		if (mask) return i + lowest_lane(mask);
+	}
+	for (; i < s.count; ++i) {
+		if (within_scalar(s, i, pt, radius2)) return i;
+	}
+	return s.count;
+}
+
+//bitmask of which of segments [i, i+8) are within range;
+// only lanes set in 'load' are read from memory (and only those can be reported):
+TARGET_AVX2
+static inline int within_avx2(SegmentArrays const &s, size_t i, __m256 px, __m256 py, __m256 r2, __m256i load) {
+	__m256 const zero = _mm256_setzero_ps();
+	__m256 const one = _mm256_set1_ps(1.0f);
+
+	__m256 dx = _mm256_maskload_ps(s.dx + i, load);
+	__m256 dy = _mm256_maskload_ps(s.dy + i, load);
+	__m256 rx = _mm256_sub_ps(px, _mm256_maskload_ps(s.ax + i, load));
+	__m256 ry = _mm256_sub_ps(py, _mm256_maskload_ps(s.ay + i, load));
+	__m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(rx, dx), _mm256_mul_ps(ry, dy)), _mm256_maskload_ps(s.inv_len2 + i, load));
+	t = _mm256_min_ps(_mm256_max_ps(t, zero), one);
+	__m256 ex = _mm256_sub_ps(rx, _mm256_mul_ps(t, dx));
+	__m256 ey = _mm256_sub_ps(ry, _mm256_mul_ps(t, dy));
+	__m256 d2 = _mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey));
+	__m256 hit = _mm256_and_ps(_mm256_cmp_ps(d2, r2, _CMP_LT_OQ), _mm256_castsi256_ps(load));
+	return _mm256_movemask_ps(hit);
+}
+
+TARGET_AVX2
+static size_t first_within_avx2(SegmentArrays const &s, glm::vec2 const &pt, float radius2) {
+	__m256 const px = _mm256_set1_ps(pt.x);
+	__m256 const py = _mm256_set1_ps(pt.y);
+	__m256 const r2 = _mm256_set1_ps(radius2);
+	__m256i const all = _mm256_set1_epi32(-1);
+
+	size_t i = 0;
+	for (; i + 8 <= s.count; i += 8) {
+		int mask = within_avx2(s, i, px, py, r2, all);
+		if (mask) return i + lowest_lane(mask);
+	}
+	//the last few segments are done with masked loads (rather than scalar code, which
+	// would mean running legacy SSE instructions with dirty upper ymm halves -- slow):
+	if (i < s.count) {
+		__m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		__m256i load = _mm256_cmpgt_epi32(_mm256_set1_epi32(int(s.count - i)), lanes);
+		int mask = within_avx2(s, i, px, py, r2, load);
+		if (mask) return i + lowest_lane(mask);
+	}
+	return s.count;
+}
+
+static bool cpu_has_avx2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx) return false;
+	//OS must save the ymm registers:
+	if ((_xgetbv(0) & 0x6) != 0x6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif //SEGMENTS_X86
+
+bool segments_impl_available(SegmentsImpl impl) {
+	if (impl == SegmentsScalar) return true;
+#ifdef SEGMENTS_X86
+	if (impl == SegmentsSSE2) return true;
+	if (impl == SegmentsAVX2) {
+		static bool const has_avx2 = cpu_has_avx2();
+		return has_avx2;
+	}
+#endif
+	return false;
+}
+
+char const *segments_impl_name(SegmentsImpl impl) {
+	if (impl == SegmentsSSE2) return "sse2";
+	if (impl == SegmentsAVX2) return "avx2";
+	return "scalar";
+}
+
+SegmentsImpl segments_best_impl() {
+	static SegmentsImpl const best = (
+		segments_impl_available(SegmentsAVX2) ? SegmentsAVX2 :
+		segments_impl_available(SegmentsSSE2) ? SegmentsSSE2 :
+		SegmentsScalar
+	);
+	return best;
+}
+
+size_t first_segment_within(SegmentsImpl impl, SegmentArrays const &segments, glm::vec2 const &pt, float radius) {
+	float radius2 = radius * radius;
+#ifdef SEGMENTS_X86
+	if (impl == SegmentsAVX2 && segments_impl_available(SegmentsAVX2)) return first_within_avx2(segments, pt, radius2);
+	if (impl == SegmentsSSE2) return first_within_sse2(segments, pt, radius2);
+#endif
+	return first_within_scalar(segments, pt, radius2);
+}
+
+size_t first_segment_within(SegmentArrays const &segments, glm::vec2 const &pt, float radius) {
+	return first_segment_within(segments_best_impl(), segments, pt, radius);
+}
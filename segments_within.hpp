@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+/*
+ * Vectorized "is this point within some distance of any of these segments" test.
+ *
+ * Segments are given as a structure-of-arrays: segment i runs from (ax[i], ay[i])
+ * to (ax[i]+dx[i], ay[i]+dy[i]), and inv_len2[i] is 1 / (dx[i]^2 + dy[i]^2)
+ * (or zero for a zero-length segment, which then acts as a point).
+ *
+ * Distances are true point-to-segment distances (i.e., the segment is a capsule),
+ * and every implementation computes them with the same float operations, so all
+ * implementations return identical results.
+ */
+
+struct SegmentArrays {
+	float const *ax;
+	float const *ay;
+	float const *dx;
+	float const *dy;
+	float const *inv_len2;
+	size_t count;
+};
+
+//index of the first segment closer than 'radius' to 'pt', or segments.count if there is none:
+// (uses the widest instruction set the CPU supports -- AVX2, SSE2, or plain scalar code)
+size_t first_segment_within(SegmentArrays const &segments, glm::vec2 const &pt, float radius);
+
+//the individual implementations (for testing and benchmarking):
+enum SegmentsImpl {
+	SegmentsScalar,
+	SegmentsSSE2,
+	SegmentsAVX2,
+};
+//is 'impl' compiled in and supported by this CPU?
+bool segments_impl_available(SegmentsImpl impl);
+char const *segments_impl_name(SegmentsImpl impl);
+//the implementation first_segment_within uses:
+SegmentsImpl segments_best_impl();
+size_t first_segment_within(SegmentsImpl impl, SegmentArrays const &segments, glm::vec2 const &pt, float radius);
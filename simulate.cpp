@@ -0,0 +1,81 @@
+//simulate runs many games of SnakeSim headless (no SDL, no OpenGL) and prints summary statistics.
+// usage: simulate [games] [max seconds per game] [updates per second]
+
+#include "SnakeSim.hpp"
+#include "PaddleBot.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+int main(int argc, char **argv) {
+	size_t games = 1000;
+	float max_time = 300.0f;
+	float tick_rate = 60.0f;
+
+	try {
+		if (argc > 1) games = std::stoul(argv[1]);
+		if (argc > 2) max_time = std::stof(argv[2]);
+		if (argc > 3) tick_rate = std::stof(argv[3]);
+	} catch (std::exception const &e) {
+		std::cerr << "usage: " << argv[0] << " [games] [max seconds per game] [updates per second]" << std::endl;
+		return 1;
+	}
+	if (games == 0 || !(max_time > 0.0f) || !(tick_rate > 0.0f)) {
+		std::cerr << "games, max seconds, and update rate must all be positive." << std::endl;
+		return 1;
+	}
+
+	SnakeSim sim(games);
+	std::vector< PaddleBot > bots;
+	for (size_t g = 0; g < sim.size(); ++g) {
+		bots.emplace_back(uint32_t(g));
+	}
+	float elapsed = 1.0f / tick_rate;
+	uint32_t max_ticks = uint32_t(max_time * tick_rate);
+
+	auto before = std::chrono::high_resolution_clock::now();
+
+	uint64_t total_updates = 0;
+	for (uint32_t tick = 0; tick < max_ticks; ++tick) {
+		size_t alive = 0;
+		//stand-in for players: bots move both paddles to where the head will cross
+		for (size_t g = 0; g < sim.size(); ++g) {
+			if (!sim.running[g]) continue;
+			alive += 1;
+			bots[g].play(sim, g, elapsed);
+		}
+		if (alive == 0) break;
+		total_updates += alive;
+
+		sim.update(elapsed);
+	}
+
+	auto after = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration< double >(after - before).count();
+
+	//----- report -----
+	size_t survived = 0;
+	double total_time = 0.0;
+	double total_length = 0.0;
+	float min_time = max_time;
+	float longest = 0.0f;
+	for (size_t g = 0; g < sim.size(); ++g) {
+		if (sim.running[g]) survived += 1;
+		total_time += sim.time[g];
+		total_length += sim.snake_length[g];
+		min_time = std::min(min_time, sim.time[g]);
+		longest = std::max(longest, sim.snake_length[g]);
+	}
+
+	std::cout << "games: " << sim.size() << " at " << tick_rate << " updates/sec, up to " << max_time << " sec each\n";
+	std::cout << "survived to time limit: " << survived << "\n";
+	std::cout << "game time: mean " << total_time / sim.size() << " sec, min " << min_time << " sec\n";
+	std::cout << "final snake length: mean " << total_length / sim.size() << ", max " << longest << "\n";
+	std::cout << "wall time: " << seconds << " sec (" << total_updates / std::max(seconds, 1e-9) << " game updates/sec)" << std::endl;
+
+	return 0;
+}
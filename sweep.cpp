@@ -0,0 +1,203 @@
+//sweep plays bot games (as in montecarlo) for many settings of the tuning constants in SnakeConfig,
+// and writes one CSV row of summary statistics per setting to standard output -- for finding balanced settings offline.
+// usage: sweep [grid|lhs] [count] [games per setting] [threads] [max seconds per game] [name=min:max ...]
+//  grid: every combination of 'count' evenly spaced values of each swept constant;
+//  lhs: 'count' settings forming a Latin hypercube (each constant's range is cut into 'count' slices, and each slice used once);
+//  name=min:max changes a constant's range (name=value holds it fixed); names are as in SnakeConfig,
+//   except court_size is split into court_width and court_height.
+//  (threads 0 means one per core)
+
+#include "bot_games.hpp"
+#include "ThreadPool.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+//a tuning constant and the range to sweep it over:
+struct Parameter {
+	char const *name;
+	float min, max;
+	bool integer; //round values to whole numbers
+	void (*set)(SnakeConfig &, float);
+};
+
+static std::vector< Parameter > parameters{
+	{"court_width", 8.0f, 12.0f, false, [](SnakeConfig &c, float v){ c.court_size.x = v; }},
+	{"court_height", 4.5f, 7.5f, false, [](SnakeConfig &c, float v){ c.court_size.y = v; }},
+	{"green_fruit_length_increase", 0.25f, 1.0f, false, [](SnakeConfig &c, float v){ c.green_fruit_length_increase = v; }},
+	{"initial_health", 3.0f, 8.0f, true, [](SnakeConfig &c, float v){ c.initial_health = int(v); }},
+	{"collision_damage", 1.0f, 3.0f, true, [](SnakeConfig &c, float v){ c.collision_damage = int(v); }},
+	{"paddle_miss_damage", 1.0f, 2.0f, true, [](SnakeConfig &c, float v){ c.paddle_miss_damage = int(v); }},
+	{"red_fruit_chance", 0.0f, 0.25f, false, [](SnakeConfig &c, float v){ c.red_fruit_chance = v; }},
+	{"initial_snake_length", 4.0f, 12.0f, false, [](SnakeConfig &c, float v){ c.initial_snake_length = v; }},
+};
+
+//value at 'amount' (in [0,1]) of the way through p's range:
+static float lerp_parameter(Parameter const &p, float amount) {
+	float v = p.min + amount * (p.max - p.min);
+	return p.integer ? std::round(v) : v;
+}
+
+//one row of values (indexed like 'parameters') per setting:
+typedef std::vector< std::vector< float > > Settings;
+
+static Settings grid_settings(size_t count) {
+	//parameters with an actual range get 'count' values, fixed ones get one:
+	std::vector< size_t > steps;
+	size_t total = 1;
+	for (auto const &p : parameters) {
+		steps.emplace_back(p.min == p.max ? 1 : count);
+		if (total > 1000000 / steps.back()) throw std::runtime_error("grid would have more than a million settings; use fewer steps, fix some constants, or try lhs.");
+		total *= steps.back();
+	}
+
+	Settings settings;
+	settings.reserve(total);
+	std::vector< size_t > at(parameters.size(), 0);
+	for (size_t s = 0; s < total; ++s) {
+		settings.emplace_back();
+		for (size_t i = 0; i < parameters.size(); ++i) {
+			settings.back().emplace_back(lerp_parameter(parameters[i], steps[i] == 1 ? 0.0f : float(at[i]) / float(steps[i] - 1)));
+		}
+		//advance like an odometer, last parameter fastest:
+		for (size_t i = parameters.size(); i > 0; --i) {
+			if (++at[i-1] < steps[i-1]) break;
+			at[i-1] = 0;
+		}
+	}
+	return settings;
+}
+
+static Settings lhs_settings(size_t count, uint32_t seed) {
+	std::mt19937 mt(seed);
+	std::uniform_real_distribution< float > jitter(0.0f, 1.0f);
+	Settings settings(count, std::vector< float >(parameters.size()));
+	std::vector< size_t > slices(count);
+	for (size_t i = 0; i < parameters.size(); ++i) {
+		//each setting gets a different slice of this parameter's range, at a random spot within the slice:
+		for (size_t s = 0; s < count; ++s) slices[s] = s;
+		std::shuffle(slices.begin(), slices.end(), mt);
+		for (size_t s = 0; s < count; ++s) {
+			settings[s][i] = lerp_parameter(parameters[i], (slices[s] + jitter(mt)) / float(count));
+		}
+	}
+	return settings;
+}
+
+//parses name=min:max (or name=value) into the matching parameter's range:
+static void parse_range(std::string const &arg) {
+	size_t eq = arg.find('=');
+	if (eq == std::string::npos) throw std::runtime_error("expected name=min:max, got '" + arg + "'.");
+	std::string name = arg.substr(0, eq);
+	for (auto &p : parameters) {
+		if (name != p.name) continue;
+		std::string range = arg.substr(eq + 1);
+		size_t colon = range.find(':');
+		p.min = std::stof(range.substr(0, colon));
+		p.max = (colon == std::string::npos ? p.min : std::stof(range.substr(colon + 1)));
+		if (p.max < p.min) std::swap(p.min, p.max);
+		return;
+	}
+	throw std::runtime_error("unknown constant '" + name + "'.");
+}
+
+int main(int argc, char **argv) {
+	std::string mode = "lhs";
+	size_t count = 64;
+	size_t games = 1024;
+	size_t threads = 0;
+	float max_time = 300.0f;
+	float const tick_rate = 60.0f;
+	float const bot_speed = 5.0f;
+
+	try {
+		if (argc > 1) mode = argv[1];
+		if (argc > 2) count = std::stoul(argv[2]);
+		if (argc > 3) games = std::stoul(argv[3]);
+		if (argc > 4) threads = std::stoul(argv[4]);
+		if (argc > 5) max_time = std::stof(argv[5]);
+		for (int a = 6; a < argc; ++a) parse_range(argv[a]);
+		if (mode != "grid" && mode != "lhs") throw std::runtime_error("mode should be 'grid' or 'lhs'.");
+		if (count == 0 || games == 0 || !(max_time > 0.0f)) throw std::runtime_error("count, games, and max seconds must all be positive.");
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << "\n";
+		std::cerr << "usage: " << argv[0] << " [grid|lhs] [count] [games per setting] [threads] [max seconds per game] [name=min:max ...]\n";
+		std::cerr << "constants:";
+		for (auto const &p : parameters) std::cerr << " " << p.name << "=" << p.min << ":" << p.max;
+		std::cerr << std::endl;
+		return 1;
+	}
+
+	Settings settings;
+	try {
+		settings = (mode == "grid" ? grid_settings(count) : lhs_settings(count, 0x5eed));
+	} catch (std::exception const &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	ThreadPool pool(threads);
+	float elapsed = 1.0f / tick_rate;
+	uint32_t max_ticks = uint32_t(max_time * tick_rate);
+	size_t batches = (games + bot_games_batch - 1) / bot_games_batch;
+
+	std::cout << "setting";
+	for (auto const &p : parameters) std::cout << "," << p.name;
+	std::cout << ",games,survived,mean_time,median_time,mean_length,mean_paddle_misses,mean_body_hits,mean_green_fruit,mean_red_fruit_heals,heal_fraction\n";
+	std::cout.flush();
+
+	//settings are played a chunk at a time (chunks big enough to keep every thread busy), and written out as each chunk finishes:
+	size_t chunk = std::max< size_t >(1, (pool.size() * 4 + batches - 1) / batches);
+	std::vector< SnakeConfig > configs;
+	std::vector< GameOutcome > outcomes;
+	for (size_t first = 0; first < settings.size(); first += chunk) {
+		size_t chunk_size = std::min(chunk, settings.size() - first);
+		configs.assign(chunk_size, SnakeConfig());
+		for (size_t c = 0; c < chunk_size; ++c) {
+			for (size_t i = 0; i < parameters.size(); ++i) {
+				parameters[i].set(configs[c], settings[first + c][i]);
+			}
+		}
+		outcomes.resize(chunk_size * games);
+
+		//every setting plays the same game seeds, so differences between rows come from the settings:
+		pool.parallel_for(chunk_size * batches, [&](size_t task, size_t) {
+			size_t c = task / batches;
+			size_t begin = (task % batches) * bot_games_batch;
+			play_bot_games(configs[c], begin, std::min(bot_games_batch, games - begin), elapsed, max_ticks, bot_speed, outcomes.data() + c * games + begin);
+		});
+
+		for (size_t c = 0; c < chunk_size; ++c) {
+			GameOutcome const *o = outcomes.data() + c * games;
+			std::vector< float > times(games);
+			size_t survived = 0, healed = 0;
+			double time = 0.0, length = 0.0, misses = 0.0, hits = 0.0, green = 0.0, heals = 0.0;
+			for (size_t g = 0; g < games; ++g) {
+				times[g] = o[g].time;
+				survived += o[g].survived;
+				healed += (o[g].red_fruit_heals > 0);
+				time += o[g].time;
+				length += o[g].length;
+				misses += o[g].paddle_misses;
+				hits += o[g].body_hits;
+				green += o[g].green_fruit_eaten;
+				heals += o[g].red_fruit_heals;
+			}
+			std::nth_element(times.begin(), times.begin() + games / 2, times.end());
+
+			std::cout << first + c;
+			for (float v : settings[first + c]) std::cout << "," << v;
+			std::cout << "," << games << "," << survived << "," << time / games << "," << times[games / 2] << "," << length / games
+				<< "," << misses / games << "," << hits / games << "," << green / games << "," << heals / games
+				<< "," << double(healed) / games << "\n";
+		}
+		std::cout.flush();
+	}
+
+	return 0;
+}